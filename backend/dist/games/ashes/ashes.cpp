@@ -10,7 +10,67 @@
 #include <string>
 #include <cmath>
 #include <algorithm>
-#include <random>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+// ======================================================================
+// Headless Build (make headless)
+// ======================================================================
+// Compiled with -DHEADLESS, no window or GL context is created. Input and
+// clock queries are redirected to a scripted state driven by HeadlessMain(),
+// which steps the game for N frames and prints per-system timings, plus the
+// bytes each enemy update streams, as JSON.
+#ifdef HEADLESS
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+enum HeadlessSystem { HS_UPDATE, HS_ENEMIES, HS_COLLISION, HS_PARTICLES, HS_COUNT };
+const char* const HEADLESS_SYSTEM_NAMES[HS_COUNT] = {"update", "enemies", "collision", "particles"};
+
+struct HeadlessState {
+    int frame = 0;
+    float frameTime = 1.0f / 60.0f;
+    bool keyDown[512] = {};
+    bool keyPressed[512] = {};
+    bool mouseDown[8] = {};
+    bool mouseReleased[8] = {};
+    Vector2 mouseDelta {0,0};
+    double systemMs[HS_COUNT] = {};
+    long long enemyUpdates = 0;     // UpdateEnemy() calls
+    long long enemyThinks = 0;      // Of which ran ThinkEnemy()
+};
+HeadlessState headless;
+
+// Accumulates the lifetime of the enclosing block into one system slot
+struct HeadlessScope {
+    HeadlessSystem system;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ~HeadlessScope() {
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        headless.systemMs[system] += ms.count();
+    }
+};
+
+#define HEADLESS_CONCAT_(a, b) a##b
+#define HEADLESS_CONCAT(a, b) HEADLESS_CONCAT_(a, b)
+#define HEADLESS_SCOPE(system) HeadlessScope HEADLESS_CONCAT(headlessScope, __LINE__){system}
+#define HEADLESS_COUNT(counter) (headless.counter++)
+
+#define IsKeyDown(key) (headless.keyDown[(key) & 511])
+#define IsKeyPressed(key) (headless.keyPressed[(key) & 511])
+#define IsMouseButtonDown(button) (headless.mouseDown[(button) & 7])
+#define IsMouseButtonPressed(button) false
+#define IsMouseButtonReleased(button) (headless.mouseReleased[(button) & 7])
+#define GetMouseDelta() (headless.mouseDelta)
+#define GetFrameTime() (headless.frameTime)
+#define GetTime() ((double)headless.frame * headless.frameTime)
+#else
+#define HEADLESS_SCOPE(system)
+#define HEADLESS_COUNT(counter)
+#endif
 
 // ======================================================================
 // Constants & Configuration
@@ -45,17 +105,288 @@ const int MAX_FLASKS = 4;
 const float FLASK_HEAL_AMOUNT = 135.0f;
 const float FLASK_USE_TIME = 1.35f;
 const float ENEMY_BASE_SPEED = 7.9f;
-const float ENEMY_ATTACK_DURATION = 0.45f;
 const float GRAVITY = -32.0f;
 const float JUMP_VELOCITY = 14.0f;
+const float SIM_HZ = 120.0f;
+const float SIM_DT = 1.0f / SIM_HZ;
+const int MAX_SIM_STEPS = 8;          // Per rendered frame before dropping time
+const float MAX_FRAME_TIME = 0.25f;   // Clamp for hitches / tab switches
+const float TRAIL_SAMPLE_INTERVAL = 0.016f;
+const int MAX_PARTICLES = 2048;
+const int PARTICLE_SPAWN_BUDGET = 192;  // New particles per sim tick
+const float OBSTACLE_HALF_WIDTH = 5.0f;   // Pillar footprint used for LOS
+const float OBSTACLE_CELL = 8.0f;
+const int OBSTACLE_GRID_DIM = 24;         // Spans the +-80 border plus pillar width
+const int OBSTACLE_GRID_CELLS = OBSTACLE_GRID_DIM * OBSTACLE_GRID_DIM;
+const float AI_LOD_FAR_RANGE = 55.0f;     // Patrollers past this think least often (sight is 40)
+const float PILLAR_HALF_WIDTH = 4.0f;     // Solid footprint; pillars are drawn 8 wide
+const float CROWD_CELL = 4.0f;
+const int CROWD_GRID_DIM = 48;            // Spans +-96; enemies past it clamp to the edge
+const int CROWD_GRID_CELLS = CROWD_GRID_DIM * CROWD_GRID_DIM;
+const float CROWD_RADIUS = 1.3f;          // Enemy body radius at scale 1
+const float PLAYER_CROWD_RADIUS = 1.4f;
+const float CROWD_STIFFNESS = 0.6f;       // Share of an overlap resolved per tick
+const int ATTACK_SLOTS = 6;               // Enemies allowed to press the player at once
+const float ATTACK_SLOT_ENGAGE = 30.0f;   // Chasers inside this compete for a slot
+const float CROWD_WAIT_RADIUS = ATTACK_RANGE + 8.0f;  // Slotless chasers circle here
+const int HORDE_ENEMY_COUNT = 300;
+const float PILLAR_SPACING = 14.0f;       // Level 1 pillar centres, >= 6 units of floor between boxes
+const float SPAWN_SPACING = 3.5f;         // Level 1 enemy spawns, clear of a tank's body
+const float SPAWN_PILLAR_CLEARANCE = 8.5f;  // From a pillar centre; leaves room for 310-430 spawns
+const int POISSON_TRIES = 30;             // Candidates per active sample before it retires
+
+// ======================================================================
+// Deterministic RNG
+// ======================================================================
+// Counter-based generator: every value is a pure function of (key, counter),
+// and a stream's key is derived from the session seed plus a stream kind,
+// entity id and sim tick. Code that runs per entity can open its own stream
+// without touching shared state, and SeedRandom() with the same seed replays
+// the whole session. Gameplay draws use the session stream `rng`; purely
+// cosmetic draws (particles, shake, messages) use `fxRng` so they never shift
+// the gameplay sequence.
+enum RngStreamKind : uint64_t { RNG_SESSION, RNG_FX, RNG_LEVEL, RNG_ENEMY_AI };
+
+uint64_t rngSeed = 1;
+
+// SplitMix64 finalizer
+constexpr uint64_t Mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+struct Rng {
+    uint64_t key = 0;
+    uint64_t counter = 0;
+
+    static Rng Stream(RngStreamKind kind, uint64_t id = 0, uint64_t tick = 0) {
+        uint64_t k = Mix64(rngSeed ^ Mix64((uint64_t)kind * 0x9E3779B97F4A7C15ull + id));
+        return {Mix64(k ^ (tick * 0xD1B54A32D192ED03ull)), 0};
+    }
+
+    uint64_t Next() { return Mix64(key + ++counter * 0x9E3779B97F4A7C15ull); }
+
+    // Inclusive on both ends, like GetRandomValue()
+    int Range(int min, int max) {
+        if (max < min) std::swap(min, max);
+        uint64_t span = (uint64_t)((int64_t)max - min) + 1;
+        return min + (int)(((Next() >> 32) * span) >> 32);
+    }
+
+    float Float(float min, float max) { return min + (max - min) * (float)(Next() >> 40) * 0x1p-24f; }
+};
+
+Rng rng;
+Rng fxRng;
+uint64_t simTick = 0;   // Fixed steps taken this session; keys per-tick streams
+
+void SeedRandom(uint64_t seed) {
+    rngSeed = seed;
+    rng = Rng::Stream(RNG_SESSION);
+    fxRng = Rng::Stream(RNG_FX);
+    simTick = 0;
+}
+
+// ======================================================================
+// Frame Profiler (make PROFILE=1)
+// ======================================================================
+// Built with -DENABLE_PROFILER, PROFILE_ZONE("name") times the enclosing
+// block into a fixed ring of events. ProfileFrameMark() opens each rendered
+// frame; F4 toggles bars for the last few frames and F5 writes the ring as
+// Chrome Trace Event JSON (load in chrome://tracing or Perfetto). Without
+// the flag every PROFILE_* macro expands to nothing.
+#ifdef ENABLE_PROFILER
+#include <chrono>
+#include <cstdio>
+
+const int PROFILE_RING_SIZE = 8192;      // Power of two
+const int PROFILE_OVERLAY_FRAMES = 3;
+const int PROFILE_MAX_DEPTH = 6;         // Deeper zones are recorded, not drawn
+const char* const PROFILE_TRACE_PATH = "profile.json";
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t endNs;
+    int depth;
+};
+
+// The game is single-threaded, so one ring with a plain head is enough:
+// events are written when their zone closes and the oldest are overwritten.
+struct Profiler {
+    ProfileEvent events[PROFILE_RING_SIZE];
+    uint64_t head = 0;
+    int depth = 1;  // Depth 0 is the frame itself
+    uint64_t frameStartNs[PROFILE_OVERLAY_FRAMES + 1] = {};
+    uint64_t frameCount = 0;
+    bool showOverlay = false;
+
+    static uint64_t Now() {
+        static const auto epoch = std::chrono::steady_clock::now();
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void Push(const char* name, uint64_t startNs, uint64_t endNs, int eventDepth) {
+        events[head & (PROFILE_RING_SIZE - 1)] = {name, startNs, endNs, eventDepth};
+        head++;
+    }
+
+    uint64_t Oldest() const { return head > PROFILE_RING_SIZE ? head - PROFILE_RING_SIZE : 0; }
+};
+Profiler profiler;
+
+struct ProfileZone {
+    const char* name;
+    uint64_t start;
+    int depth;
+    explicit ProfileZone(const char* zoneName)
+        : name(zoneName), start(Profiler::Now()), depth(profiler.depth++) {}
+    ~ProfileZone() {
+        profiler.depth--;
+        profiler.Push(name, start, Profiler::Now(), depth);
+    }
+};
+
+bool ProfileWriteTrace(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\"traceEvents\":[");
+    for (uint64_t i = profiler.Oldest(); i < profiler.head; i++) {
+        const ProfileEvent& ev = profiler.events[i & (PROFILE_RING_SIZE - 1)];
+        fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":0}",
+                i > profiler.Oldest() ? "," : "", ev.name, ev.startNs / 1000.0,
+                (ev.endNs - ev.startNs) / 1000.0);
+    }
+    fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+    return true;
+}
+
+// Closes the previous frame as a depth-0 event and handles the hotkeys
+void ProfileFrameMark() {
+    uint64_t now = Profiler::Now();
+    if (profiler.frameCount > 0) {
+        profiler.Push("Frame", profiler.frameStartNs[PROFILE_OVERLAY_FRAMES], now, 0);
+    }
+    for (int i = 0; i < PROFILE_OVERLAY_FRAMES; i++) profiler.frameStartNs[i] = profiler.frameStartNs[i + 1];
+    profiler.frameStartNs[PROFILE_OVERLAY_FRAMES] = now;
+    profiler.frameCount++;
+
+    if (IsKeyPressed(KEY_F4)) profiler.showOverlay = !profiler.showOverlay;
+    if (IsKeyPressed(KEY_F5)) {
+        bool ok = ProfileWriteTrace(PROFILE_TRACE_PATH);
+        TraceLog(ok ? LOG_INFO : LOG_WARNING, "PROFILER: %s %s", ok ? "wrote" : "could not write", PROFILE_TRACE_PATH);
+    }
+}
+
+// Timeline of the last completed frames: one bar row per nesting depth,
+// frame boundaries as vertical lines
+void ProfileDrawOverlay() {
+    uint64_t begin = profiler.frameStartNs[0], end = profiler.frameStartNs[PROFILE_OVERLAY_FRAMES];
+    if (!profiler.showOverlay || begin == 0) return;
+    const int rowH = 16, x0 = 20, width = SCREEN_WIDTH - 40;
+    const int y0 = SCREEN_HEIGHT - 20 - rowH * PROFILE_MAX_DEPTH;
+    const float pxPerNs = (float)width / (float)(end - begin);
+
+    DrawRectangle(x0 - 6, y0 - 26, width + 12, rowH * PROFILE_MAX_DEPTH + 32, Fade(BLACK, 0.75f));
+    DrawText(TextFormat("PROFILER  %d FRAMES  AVG %.2f MS", PROFILE_OVERLAY_FRAMES,
+                        (end - begin) / 1e6 / PROFILE_OVERLAY_FRAMES), x0, y0 - 22, 16, LIME);
+    for (int f = 0; f <= PROFILE_OVERLAY_FRAMES; f++) {
+        int fx = x0 + (int)((profiler.frameStartNs[f] - begin) * pxPerNs);
+        DrawLine(fx, y0, fx, y0 + rowH * PROFILE_MAX_DEPTH, Fade(RED, 0.6f));
+    }
+
+    for (uint64_t i = profiler.head; i-- > profiler.Oldest(); ) {
+        const ProfileEvent& ev = profiler.events[i & (PROFILE_RING_SIZE - 1)];
+        if (ev.endNs < begin) break;  // Events are stored in end order
+        if (ev.startNs >= end || ev.depth >= PROFILE_MAX_DEPTH) continue;
+        uint64_t s = std::max(ev.startNs, begin), e = std::min(ev.endNs, end);
+        int bx = x0 + (int)((s - begin) * pxPerNs);
+        int bw = std::max(1, (int)((e - s) * pxPerNs));
+        int by = y0 + ev.depth * rowH;
+        unsigned hash = (unsigned)((uintptr_t)ev.name * 2654435761u);
+        DrawRectangle(bx, by, bw, rowH - 2, ColorFromHSV((float)(hash % 360), 0.55f, 0.85f));
+        if (bw > 70) {
+            DrawText(TextFormat("%s %.2f", ev.name, (ev.endNs - ev.startNs) / 1e6), bx + 2, by + 2, 10, BLACK);
+        }
+    }
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__){name}
+#define PROFILE_FRAME() ProfileFrameMark()
+#define PROFILE_OVERLAY() ProfileDrawOverlay()
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_FRAME()
+#define PROFILE_OVERLAY()
+#endif
 
 // ======================================================================
 // Enums
 // ======================================================================
 enum GameState { TITLE_SCREEN, PLAYING, PAUSED, DEAD, VICTORY };
-enum EnemyType { GRUNT, TANK, AGILE, BOSS };
-enum EnemyState { PATROL, ALERT, CHASE, SEARCH, STAGGERED };
-enum AttackType { LIGHT_1, LIGHT_2, LIGHT_3, HEAVY, DASH_ATTACK };
+enum EnemyType : uint8_t { GRUNT, TANK, AGILE, BOSS, ENEMY_TYPE_COUNT };
+enum EnemyState : uint8_t { PATROL, ALERT, CHASE, SEARCH, STAGGERED };
+enum AiLod { AI_LOD_FULL, AI_LOD_MID, AI_LOD_FAR, AI_LOD_COUNT };
+enum AttackType : uint8_t { LIGHT_1, LIGHT_2, LIGHT_3, HEAVY, DASH_ATTACK };
+
+// ======================================================================
+// Enemy Archetypes
+// ======================================================================
+// Everything that is fixed per enemy type lives here rather than in each
+// Enemy. The update kernels are instantiated per type (UpdateEnemyGroup<T>),
+// so reads from this table fold to constants and the per-type behaviour
+// (boss combos, tank blocks, agile side-steps) compiles out of the other
+// kernels instead of being branched on every tick.
+struct EnemyArchetype {
+    int spawnWeight;            // Share of rng.Range(0, 100)'s 101 values on level 1
+    float scale;
+    int health;
+    float poise;
+    float speed;                // Multiple of ENEMY_BASE_SPEED
+    Color bodyColor;
+    float attackDamage;
+    float poiseDamage;
+    float attackDur;
+    float dodgeChance;
+    float patrolRadiusScale;
+    float chaseForwardFar;      // Chase steering weights, outside / inside ATTACK_RANGE + 3
+    float chaseForwardNear;
+    float chaseStrafe;
+    float chaseSpeedScale;
+    float attackCooldown;       // Base seconds between attacks
+    int heavyPercent;           // Attacks that try to be heavies
+    int blockPercent;           // Reactive shield blocks against player swings
+    int sideStepPercent;        // Dodges that veer sideways
+};
+
+constexpr EnemyArchetype ENEMY_ARCHETYPES[ENEMY_TYPE_COUNT] = {
+    // wt scale  hp    poise   speed  body                 attack poise  dur    dodge  patrol fwdF  fwdN  strafe spd    cd    hvy blk side
+    {  45, 0.95f,  180,  65.0f, 1.05f, {140,  40,  60, 255}, 31.0f, 36.0f, 0.43f, 0.52f, 1.0f, 0.6f, 0.3f, 0.7f, 1.00f, 1.6f,  0,  0,  0},  // GRUNT
+    {  35, 1.28f,  340, 160.0f, 0.82f, { 60,  80, 160, 255}, 46.0f, 60.0f, 0.60f, 0.25f, 0.7f, 0.8f, 0.6f, 0.3f, 1.00f, 2.5f, 40, 75,  0},  // TANK
+    {  21, 1.05f,  160,  55.0f, 1.25f, {100, 180,  80, 255}, 27.0f, 32.0f, 0.36f, 0.82f, 1.0f, 0.4f, 0.1f, 0.9f, 1.15f, 0.9f,  0,  0, 60},  // AGILE
+    {   0, 2.30f, 1600, 320.0f, 0.88f, {180,  30,  50, 255}, 48.0f, 72.0f, 0.55f, 0.35f, 1.0f, 0.0f, 0.0f, 0.0f, 1.10f, 0.0f,  0,  0,  0},  // BOSS
+};
+static_assert(ENEMY_ARCHETYPES[GRUNT].spawnWeight + ENEMY_ARCHETYPES[TANK].spawnWeight +
+              ENEMY_ARCHETYPES[AGILE].spawnWeight == 101, "level 1 rolls rng.Range(0, 100)");
+
+constexpr const EnemyArchetype& Archetype(EnemyType type) { return ENEMY_ARCHETYPES[type]; }
+
+// Level 1 type for a rng.Range(0, 100) roll
+constexpr EnemyType RollEnemyType(int roll) {
+    int cumulative = 0;
+    for (int type = GRUNT; type < AGILE; type++) {
+        cumulative += ENEMY_ARCHETYPES[type].spawnWeight;
+        if (roll < cumulative) return (EnemyType)type;
+    }
+    return AGILE;
+}
+static_assert(RollEnemyType(44) == GRUNT && RollEnemyType(45) == TANK &&
+              RollEnemyType(79) == TANK && RollEnemyType(80) == AGILE && RollEnemyType(100) == AGILE);
 
 // ======================================================================
 // Structs
@@ -69,11 +400,57 @@ struct Particle {
     float size;
 };
 
+// Fixed-capacity particle storage. Live particles are packed at the front,
+// removal swaps the last live particle into the hole (order is not kept).
+// Spawn() returns nullptr once the pool or this tick's budget is exhausted.
+struct ParticlePool {
+    Particle items[MAX_PARTICLES];
+    int count = 0;
+    int spawnedThisTick = 0;
+    int peakCount = 0;
+    int dropped = 0;
+
+    Particle* Spawn() {
+        if (count >= MAX_PARTICLES || spawnedThisTick >= PARTICLE_SPAWN_BUDGET) {
+            dropped++;
+            return nullptr;
+        }
+        spawnedThisTick++;
+        Particle* p = &items[count++];
+        *p = {};
+        peakCount = std::max(peakCount, count);
+        return p;
+    }
+    void Kill(int i) { items[i] = items[--count]; }
+    void BeginTick() { spawnedThisTick = 0; }
+    void Clear() { count = 0; spawnedThisTick = 0; }
+    Particle* begin() { return items; }
+    Particle* end() { return items + count; }
+    const Particle* begin() const { return items; }
+    const Particle* end() const { return items + count; }
+};
+
 struct TrailPoint {
     Vector3 pos;
     float time;
 };
 
+// Input latched once per rendered frame and consumed by the sim steps.
+// Held keys are level-triggered; pressed/released edges and the mouse delta
+// accumulate until the first step that sees them.
+struct InputFrame {
+    Vector2 mouseDelta {0,0};
+    bool forward = false, back = false, left = false, right = false;
+    bool sprintHeld = false;
+    bool attackHeld = false;
+    bool attackReleased = false;
+    bool lockPressed = false;
+    bool rollPressed = false;
+    bool jumpPressed = false;
+    bool flaskPressed = false;
+    bool parryPressed = false;
+};
+
 struct Weapon {
     std::string name;
     float damageMultiplier;
@@ -125,183 +502,1363 @@ struct Player {
     float healTimer = 0.0f;
     float perfectRollTimer = 0.0f;
     float riposteTimer = 0.0f;
+    // Previous sim state for render interpolation
+    Vector3 prevPosition {0,0,0};
+    float prevRotation = 0.0f;
+    float prevSwingYaw = 30.0f;
+    float prevSwingPitch = -30.0f;
 };
 
+// Per-tick simulation state, i.e. everything UpdateEnemy() and the crowd pass
+// touch for every enemy every tick. Widest fields first so the record packs
+// into two cache lines. Per-type constants are in ENEMY_ARCHETYPES; state only the
+// staggered ThinkEnemy() or the renderer read is in EnemyMemory and
+// EnemyPrevPose, stored in arrays parallel to `enemies`.
 struct Enemy {
-    EnemyType type;
     Vector3 position {0,0,0};
     Vector3 velocity {0,0,0};
+    Vector3 dodgeDirection {0,0,0};
+    // Last ThinkEnemy() decision, replayed every tick until the next one
+    Vector3 moveDir {0,0,0};
+    float moveScale = 1.0f;
+    float thinkAccum = 0.0f;
     float rotation = 0.0f;
-    int health = 220;
-    int maxHealth = 220;
     float stamina = MAX_STAMINA;
     float staminaRegenDelay = 0.0f;
     float poise = 80.0f;
-    float maxPoise = 80.0f;
-    bool alive = true;
-    bool isAttacking = false;
     float attackTimer = 0.0f;
-    AttackType currentAttack = LIGHT_1;
-    bool isHeavyAttack = false;
-    bool isDodging = false;
     float dodgeTimer = 0.0f;
-    Vector3 dodgeDirection {0,0,0};
-    Vector3 dodgeStartPos {0,0,0};
-    bool isBlocking = false;
     float blockTimer = 0.0f;
     float hitInvuln = 0.0f;
     float stunTimer = 0.0f;
+    float swingYaw = 30.0f;
+    float swingPitch = -30.0f;
+    int health = 220;
+    int comboStep = 0;
+    int attackSlot = -1;            // From AssignAttackSlots(), -1 when not pressing the player
+    EnemyType type = GRUNT;
     EnemyState state = PATROL;
-    Vector3 homePosition;
+    AttackType currentAttack = LIGHT_1;
+    bool alive = true;
+    bool isAttacking = false;
+    bool isHeavyAttack = false;
+    bool isDodging = false;
+    bool isBlocking = false;
+};
+static_assert(sizeof(Enemy) <= 128, "Enemy is streamed by every sim tick, keep cold state out of it");
+
+// Awareness, patrol and pacing state that only ThinkEnemy() reads, which at
+// the coarser AI LODs is once every few ticks
+struct EnemyMemory {
+    Vector3 homePosition {0,0,0};
+    Vector3 patrolTarget {0,0,0};
+    Vector3 lastKnownPlayerPos {0,0,0};
     float patrolRadius = 22.0f;
-    Vector3 patrolTarget;
     float patrolTimer = 0.0f;
-    Vector3 lastKnownPlayerPos;
     float alertTimer = 0.0f;
-    Color bodyColor;
-    float scale = 1.0f;
-    float speed = ENEMY_BASE_SPEED;
     float strafeSide = 1.0f;
     float strafeTimer = 4.0f;
     float attackCooldown = 0.0f;
-    Vector3 bladeStart, bladeEnd;
+    float comboDelayTimer = 0.0f;
+};
+
+// Previous sim pose for render interpolation, written by
+// SaveInterpolationState() and read by DrawEnemy()
+struct EnemyPrevPose {
+    Vector3 position {0,0,0};
+    float rotation = 0.0f;
     float swingYaw = 30.0f;
     float swingPitch = -30.0f;
-    float attackDamage = 32.0f;
-    float poiseDamage = 38.0f;
-    float attackDur = ENEMY_ATTACK_DURATION;
-    float dodgeChance = 0.55f;
-    int comboStep = 0;
-    float comboDelayTimer = 0.0f;
 };
 
-// ======================================================================
-// Global Variables
-// ======================================================================
-GameState gameState = TITLE_SCREEN;
-int currentLevel = 1;
-Player player;
-std::vector<Enemy> enemies;
-std::vector<Vector3> obstacles;
-Vector3 exitPosition;
-bool exitActive = false;
-std::vector<Particle> particles;
-std::vector<TrailPoint> weaponTrail;
-Camera3D camera = { 0 };
-Vector3 camPos = {0, CAMERA_HEIGHT, CAMERA_DISTANCE};
-float hitStopTimer = 0.0f;
-std::vector<std::string> deathMessages = {
-    "Skill Issue", "Git Gud", "Just Roll", "You Got Parried", "Touch Grass",
-    "Ratio + L", "Downvoted to Oblivion", "Engagement Farm Failed",
-    "Praise the Algorithm", "Try Tongue But Hole", "404 – Skill Not Found"
-};
-const char* currentDeathMessage = "Git Gud";
+// Static XZ grid over the pillars, rebuilt whenever the level is generated.
+// Each pillar is listed in every cell its LOS footprint touches, so a visit
+// may see the same pillar twice; all queries are "any hit" and don't care.
+// Points outside the grid clamp to the border cells.
+struct ObstacleGrid {
+    int cellStart[OBSTACLE_GRID_CELLS + 1] = {0};
+    std::vector<Vector3> items;
+
+    static int CellCoord(float v) {
+        int c = (int)floorf(v / OBSTACLE_CELL) + OBSTACLE_GRID_DIM / 2;
+        return std::clamp(c, 0, OBSTACLE_GRID_DIM - 1);
+    }
+
+    template <typename Fn>
+    void ForEachFootprintCell(Vector3 obs, Fn&& fn) const {
+        int x0 = CellCoord(obs.x - OBSTACLE_HALF_WIDTH), x1 = CellCoord(obs.x + OBSTACLE_HALF_WIDTH);
+        int z0 = CellCoord(obs.z - OBSTACLE_HALF_WIDTH), z1 = CellCoord(obs.z + OBSTACLE_HALF_WIDTH);
+        for (int z = z0; z <= z1; z++) {
+            for (int x = x0; x <= x1; x++) fn(z * OBSTACLE_GRID_DIM + x);
+        }
+    }
+
+    void Build(const std::vector<Vector3>& list) {
+        std::fill(cellStart, cellStart + OBSTACLE_GRID_CELLS + 1, 0);
+        for (const auto& obs : list) {
+            ForEachFootprintCell(obs, [&](int c) { cellStart[c + 1]++; });
+        }
+        for (int c = 0; c < OBSTACLE_GRID_CELLS; c++) cellStart[c + 1] += cellStart[c];
+        items.resize(cellStart[OBSTACLE_GRID_CELLS]);
+        std::vector<int> fill(cellStart, cellStart + OBSTACLE_GRID_CELLS);
+        for (const auto& obs : list) {
+            ForEachFootprintCell(obs, [&](int c) { items[fill[c]++] = obs; });
+        }
+    }
+
+    template <typename Fn>
+    bool AnyInCell(int x, int z, Fn&& pred) const {
+        int c = z * OBSTACLE_GRID_DIM + x;
+        for (int k = cellStart[c]; k < cellStart[c + 1]; k++) {
+            if (pred(items[k])) return true;
+        }
+        return false;
+    }
+
+    // True if any pillar center lies within radius of p (3D distance, as before)
+    bool AnyWithin(Vector3 p, float radius) const {
+        int x0 = CellCoord(p.x - radius), x1 = CellCoord(p.x + radius);
+        int z0 = CellCoord(p.z - radius), z1 = CellCoord(p.z + radius);
+        auto near = [&](Vector3 obs) { return Vector3Distance(p, obs) < radius; };
+        for (int z = z0; z <= z1; z++) {
+            for (int x = x0; x <= x1; x++) {
+                if (AnyInCell(x, z, near)) return true;
+            }
+        }
+        return false;
+    }
+
+    // True if a pillar box blocks the segment from -> to. Walks only the
+    // cells the segment crosses (2D DDA) instead of testing every pillar.
+    bool SegmentBlocked(Vector3 from, Vector3 to, float margin) const {
+        Vector3 delta = Vector3Subtract(to, from);
+        float dist = Vector3Length(delta);
+        if (dist <= 0.0f) return false;
+        Ray ray{from, Vector3Scale(delta, 1.0f / dist)};
+        auto blocks = [&](Vector3 obs) {
+            Vector3 half = {OBSTACLE_HALF_WIDTH, 7.0f, OBSTACLE_HALF_WIDTH};
+            BoundingBox box = {Vector3Subtract(obs, half), Vector3Add(obs, half)};
+            RayCollision col = GetRayCollisionBox(ray, box);
+            return col.hit && col.distance < dist - margin;
+        };
+
+        // Segment parameter t in [0, 1]; tMax* is where the next cell edge is crossed
+        int x = CellCoord(from.x), z = CellCoord(from.z);
+        int stepX = delta.x > 0 ? 1 : -1, stepZ = delta.z > 0 ? 1 : -1;
+        auto edge = [](int cell, int step) { return (float)(cell - OBSTACLE_GRID_DIM / 2 + (step > 0)) * OBSTACLE_CELL; };
+        float tMaxX = delta.x != 0.0f ? (edge(x, stepX) - from.x) / delta.x : INFINITY;
+        float tMaxZ = delta.z != 0.0f ? (edge(z, stepZ) - from.z) / delta.z : INFINITY;
+        float tDeltaX = delta.x != 0.0f ? OBSTACLE_CELL / fabsf(delta.x) : INFINITY;
+        float tDeltaZ = delta.z != 0.0f ? OBSTACLE_CELL / fabsf(delta.z) : INFINITY;
+        while (true) {
+            if (AnyInCell(x, z, blocks)) return true;
+            if (std::min(tMaxX, tMaxZ) > 1.0f) return false;
+            if (tMaxX < tMaxZ) { x += stepX; tMaxX += tDeltaX; }
+            else { z += stepZ; tMaxZ += tDeltaZ; }
+            if (x < 0 || x >= OBSTACLE_GRID_DIM || z < 0 || z >= OBSTACLE_GRID_DIM) return false;
+        }
+    }
+
+    // Moves p out of every pillar footprint grown by radius, along the
+    // shallower axis, so a body pressed into a face slides along it
+    Vector3 PushOut(Vector3 p, float radius) const {
+        float reach = PILLAR_HALF_WIDTH + radius;
+        int x0 = CellCoord(p.x - reach), x1 = CellCoord(p.x + reach);
+        int z0 = CellCoord(p.z - reach), z1 = CellCoord(p.z + reach);
+        auto push = [&](Vector3 obs) {
+            float dx = p.x - obs.x, dz = p.z - obs.z;
+            float depthX = reach - fabsf(dx), depthZ = reach - fabsf(dz);
+            if (depthX <= 0.0f || depthZ <= 0.0f) return false;
+            if (depthX < depthZ) p.x += (dx < 0.0f) ? -depthX : depthX;
+            else p.z += (dz < 0.0f) ? -depthZ : depthZ;
+            return false;  // Keep visiting
+        };
+        for (int z = z0; z <= z1; z++) {
+            for (int x = x0; x <= x1; x++) AnyInCell(x, z, push);
+        }
+        return p;
+    }
+};
+
+float CrowdRadius(const Enemy& e) { return CROWD_RADIUS * Archetype(e.type).scale; }
+
+// Living enemies bucketed by the cell holding their centre, rebuilt every
+// sim tick by ResolveCrowd() with the same counting sort as ObstacleGrid.
+// Neighbour queries widen by maxRadius so large bodies (the boss) are never
+// missed from a neighbouring cell.
+struct CrowdGrid {
+    int cellStart[CROWD_GRID_CELLS + 1] = {0};
+    std::vector<int> items;         // Enemy indices, grouped by cell
+    std::vector<int> cellOf;        // Per enemy, -1 if dead
+    float maxRadius = 0.0f;
+
+    static int CellCoord(float v) {
+        int c = (int)floorf(v / CROWD_CELL) + CROWD_GRID_DIM / 2;
+        return std::clamp(c, 0, CROWD_GRID_DIM - 1);
+    }
+
+    void Build(const std::vector<Enemy>& list) {
+        std::fill(cellStart, cellStart + CROWD_GRID_CELLS + 1, 0);
+        cellOf.assign(list.size(), -1);
+        maxRadius = 0.0f;
+        for (size_t i = 0; i < list.size(); i++) {
+            if (!list[i].alive) continue;
+            cellOf[i] = CellCoord(list[i].position.z) * CROWD_GRID_DIM + CellCoord(list[i].position.x);
+            cellStart[cellOf[i] + 1]++;
+            maxRadius = std::max(maxRadius, CrowdRadius(list[i]));
+        }
+        for (int c = 0; c < CROWD_GRID_CELLS; c++) cellStart[c + 1] += cellStart[c];
+        items.resize(cellStart[CROWD_GRID_CELLS]);
+        std::vector<int> fill(cellStart, cellStart + CROWD_GRID_CELLS);
+        for (size_t i = 0; i < list.size(); i++) {
+            if (cellOf[i] >= 0) items[fill[cellOf[i]]++] = (int)i;
+        }
+    }
+
+    // Calls fn(index) for every enemy whose cell overlaps p +- radius
+    template <typename Fn>
+    void ForEachNear(Vector3 p, float radius, Fn&& fn) const {
+        int x0 = CellCoord(p.x - radius), x1 = CellCoord(p.x + radius);
+        int z0 = CellCoord(p.z - radius), z1 = CellCoord(p.z + radius);
+        for (int z = z0; z <= z1; z++) {
+            for (int x = x0; x <= x1; x++) {
+                int c = z * CROWD_GRID_DIM + x;
+                for (int k = cellStart[c]; k < cellStart[c + 1]; k++) fn(items[k]);
+            }
+        }
+    }
+};
+
+// Bridson's Poisson-disk sampling over an XZ rectangle: every accepted
+// point is at least minDist from every other. The background grid's cells
+// are minDist/sqrt(2) wide, so each holds at most one point and a candidate
+// only checks the 5x5 cells around it. Each sample spends POISSON_TRIES
+// candidates in the ring [minDist, 2 * minDist) before it retires, and one
+// random dart per grid cell seeds growth in regions the accept test cuts
+// off from the rest, so a fill is O(cells + points * POISSON_TRIES).
+struct PoissonDisk {
+    float minDist = 1.0f;
+    float cellSize = 1.0f;
+    Vector2 lo {0,0}, hi {0,0};
+    int cols = 0, rows = 0;
+    std::vector<int> cells;         // Index into points, -1 when empty
+    std::vector<Vector3> points;
+
+    void Reset(Vector2 min, Vector2 max, float spacing) {
+        minDist = spacing;
+        cellSize = spacing / sqrtf(2.0f);
+        lo = min;
+        hi = max;
+        cols = (int)ceilf((hi.x - lo.x) / cellSize);
+        rows = (int)ceilf((hi.y - lo.y) / cellSize);
+        cells.assign(cols * rows, -1);
+        points.clear();
+    }
+
+    int Cell(Vector3 p) const {
+        int x = std::clamp((int)((p.x - lo.x) / cellSize), 0, cols - 1);
+        int z = std::clamp((int)((p.z - lo.y) / cellSize), 0, rows - 1);
+        return z * cols + x;
+    }
+
+    bool Fits(Vector3 p) const {
+        if (p.x < lo.x || p.x >= hi.x || p.z < lo.y || p.z >= hi.y) return false;
+        int c = Cell(p), cx = c % cols, cz = c / cols;
+        for (int z = std::max(cz - 2, 0); z <= std::min(cz + 2, rows - 1); z++) {
+            for (int x = std::max(cx - 2, 0); x <= std::min(cx + 2, cols - 1); x++) {
+                int i = cells[z * cols + x];
+                if (i >= 0 && Vector3Distance(points[i], p) < minDist) return false;
+            }
+        }
+        return true;
+    }
+
+    void Insert(Vector3 p) {
+        cells[Cell(p)] = (int)points.size();
+        points.push_back(p);
+    }
+
+    // Fills the domain with points that pass accept(p) until no sample can
+    // place another
+    template <typename Fn>
+    void Fill(Rng& r, Fn&& accept) {
+        std::vector<int> active;
+        for (size_t dart = 0; dart < cells.size(); dart++) {
+            Vector3 seed = {r.Float(lo.x, hi.x), 0.0f, r.Float(lo.y, hi.y)};
+            if (!Fits(seed) || !accept(seed)) continue;
+            active.push_back((int)points.size());
+            Insert(seed);
+            while (!active.empty()) {
+                int slot = r.Range(0, (int)active.size() - 1);
+                Vector3 from = points[active[slot]];
+                bool placed = false;
+                for (int t = 0; t < POISSON_TRIES && !placed; t++) {
+                    float ang = r.Float(0.0f, 2.0f * PI);
+                    float dist = minDist * (1.0f + r.Float(0.0f, 1.0f));
+                    Vector3 p = {from.x + cosf(ang) * dist, 0.0f, from.z + sinf(ang) * dist};
+                    if (Fits(p) && accept(p)) {
+                        active.push_back((int)points.size());
+                        Insert(p);
+                        placed = true;
+                    }
+                }
+                if (!placed) {
+                    active[slot] = active.back();
+                    active.pop_back();
+                }
+            }
+        }
+    }
+};
+
+// ======================================================================
+// Global Variables
+// ======================================================================
+GameState gameState = TITLE_SCREEN;
+int currentLevel = 1;
+Player player;
+std::vector<Enemy> enemies;
+std::vector<EnemyMemory> enemyMemory;       // Same indices as enemies
+std::vector<EnemyPrevPose> enemyPrevPose;   // Same indices as enemies
+std::vector<Vector3> obstacles;
+ObstacleGrid obstacleGrid;  // Rebuilt from obstacles in ResetLevel()
+CrowdGrid crowdGrid;        // Rebuilt from enemies every sim tick
+PoissonDisk levelSampler;   // Scratch for ResetLevel()
+std::vector<int> enemyGroups[ENEMY_TYPE_COUNT];  // Enemy indices by type, from ResetLevel()
+std::vector<Vector3> crowdPush;
+std::vector<std::pair<float, int>> slotCandidates;
+int attackSlotsTaken = 0;   // Last sim tick, for the debug overlay
+bool hordeMode = false;     // Level 1 with HORDE_ENEMY_COUNT enemies
+Vector3 exitPosition;
+bool exitActive = false;
+bool showDebugOverlay = false;
+ParticlePool particles;
+std::vector<TrailPoint> weaponTrail;
+Camera3D camera = { 0 };
+Vector3 camPos = {0, CAMERA_HEIGHT, CAMERA_DISTANCE};
+float hitStopTimer = 0.0f;
+float trailSampleTimer = 0.0f;
+InputFrame input;
+float simAccumulator = 0.0f;
+float renderAlpha = 1.0f;
+int aiLodCounts[AI_LOD_COUNT] = {};  // Living enemies per AI LOD, last sim tick
+int levelOneEnemyCount = 14;  // Ignored in horde mode
+Vector3 prevCameraPosition = {0, CAMERA_HEIGHT, CAMERA_DISTANCE};
+Vector3 prevCameraTarget = {0, 0, 0};
+std::vector<std::string> deathMessages = {
+    "Skill Issue", "Git Gud", "Just Roll", "You Got Parried", "Touch Grass",
+    "Ratio + L", "Downvoted to Oblivion", "Engagement Farm Failed",
+    "Praise the Algorithm", "Try Tongue But Hole", "404 – Skill Not Found"
+};
+const char* currentDeathMessage = "Git Gud";
+
+// ======================================================================
+// Instanced Renderer
+// ======================================================================
+// Particles (and other swarms of identical primitives) are drawn as
+// instances of one low-poly unit mesh. Each DrawInstance() appends
+// {center, size, colour} to a CPU buffer; FlushInstances() uploads it and
+// issues a single instanced draw, instead of one tessellated immediate-mode
+// DrawSphere per particle. Without a usable shader or VAO (or in the
+// HEADLESS build) DrawInstance() falls back to the immediate-mode call.
+const int MAX_INSTANCES = 4096;
+const int INSTANCE_ATTRIB_CENTER = 12;  // Must match the layout() in the shader
+const int INSTANCE_ATTRIB_COLOR = 13;
+
+#ifdef __EMSCRIPTEN__
+#define INSTANCE_GLSL_VERSION "#version 300 es\nprecision mediump float;\n"
+#else
+#define INSTANCE_GLSL_VERSION "#version 330\n"
+#endif
+
+const char* const INSTANCE_VS = INSTANCE_GLSL_VERSION R"(
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 12) in vec4 instanceCenter;  // xyz = center, w = size
+layout(location = 13) in vec4 instanceColor;
+uniform mat4 mvp;
+out vec4 fragColor;
+void main() {
+    fragColor = instanceColor;
+    gl_Position = mvp * vec4(instanceCenter.xyz + vertexPosition * instanceCenter.w, 1.0);
+}
+)";
+
+const char* const INSTANCE_FS = INSTANCE_GLSL_VERSION R"(
+in vec4 fragColor;
+out vec4 finalColor;
+void main() { finalColor = fragColor; }
+)";
+
+struct InstanceData {
+    float x, y, z, size;
+    unsigned char r, g, b, a;
+};
+
+enum InstanceShape { INSTANCE_SPHERE, INSTANCE_CUBE };
+
+struct InstanceBatch {
+    InstanceShape shape = INSTANCE_SPHERE;
+    unsigned int vao = 0;
+    unsigned int meshVbo = 0;
+    unsigned int indexVbo = 0;
+    unsigned int instanceVbo = 0;
+    int vertexCount = 0;
+    int indexCount = 0;
+    bool ready = false;
+    int count = 0;
+    InstanceData instances[MAX_INSTANCES];
+};
+
+Shader instanceShader = {0};
+int instanceMvpLoc = -1;
+int instanceDrawCalls = 0;  // Since ResetInstanceStats(), for the debug overlay
+int instancesDrawn = 0;
+InstanceBatch sphereBatch;
+
+// Unit mesh: sphere of radius 1 or cube of edge 1, matching DrawSphere/DrawCube sizes
+void InitInstanceBatch(InstanceBatch& batch, InstanceShape shape) {
+    batch.shape = shape;
+    if (instanceShader.id == 0) {
+        instanceShader = LoadShaderFromMemory(INSTANCE_VS, INSTANCE_FS);
+        instanceMvpLoc = GetShaderLocation(instanceShader, "mvp");
+    }
+    if (instanceShader.id == rlGetShaderIdDefault()) return;  // Compile failed
+
+    Mesh mesh = (shape == INSTANCE_SPHERE) ? GenMeshSphere(1.0f, 8, 10) : GenMeshCube(1.0f, 1.0f, 1.0f);
+    batch.vao = rlLoadVertexArray();
+    if (batch.vao == 0) {
+        UnloadMesh(mesh);
+        return;
+    }
+    rlEnableVertexArray(batch.vao);
+    batch.vertexCount = mesh.vertexCount;
+    batch.meshVbo = rlLoadVertexBuffer(mesh.vertices, mesh.vertexCount * 3 * sizeof(float), false);
+    rlSetVertexAttribute(0, 3, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(0);
+    if (mesh.indices) {
+        batch.indexCount = mesh.triangleCount * 3;
+        batch.indexVbo = rlLoadVertexBufferElement(mesh.indices, batch.indexCount * sizeof(unsigned short), false);
+    }
+
+    batch.instanceVbo = rlLoadVertexBuffer(nullptr, sizeof(batch.instances), true);
+    rlSetVertexAttribute(INSTANCE_ATTRIB_CENTER, 4, RL_FLOAT, false, sizeof(InstanceData), 0);
+    rlEnableVertexAttribute(INSTANCE_ATTRIB_CENTER);
+    rlSetVertexAttributeDivisor(INSTANCE_ATTRIB_CENTER, 1);
+    rlSetVertexAttribute(INSTANCE_ATTRIB_COLOR, 4, RL_UNSIGNED_BYTE, true, sizeof(InstanceData),
+                         offsetof(InstanceData, r));
+    rlEnableVertexAttribute(INSTANCE_ATTRIB_COLOR);
+    rlSetVertexAttributeDivisor(INSTANCE_ATTRIB_COLOR, 1);
+    rlDisableVertexArray();
+
+    UnloadMesh(mesh);
+    batch.ready = true;
+}
+
+void UnloadInstanceBatch(InstanceBatch& batch) {
+    if (!batch.ready) return;
+    rlUnloadVertexArray(batch.vao);
+    rlUnloadVertexBuffer(batch.meshVbo);
+    if (batch.indexVbo) rlUnloadVertexBuffer(batch.indexVbo);
+    rlUnloadVertexBuffer(batch.instanceVbo);
+    batch.ready = false;
+}
+
+void FlushInstances(InstanceBatch& batch) {
+    if (batch.count == 0) return;
+    rlDrawRenderBatchActive();  // Keep draw order with the immediate-mode geometry
+
+    Matrix modelView = MatrixMultiply(rlGetMatrixTransform(), rlGetMatrixModelview());
+    rlEnableShader(instanceShader.id);
+    rlSetUniformMatrix(instanceMvpLoc, MatrixMultiply(modelView, rlGetMatrixProjection()));
+    rlEnableVertexArray(batch.vao);
+    rlUpdateVertexBuffer(batch.instanceVbo, batch.instances, batch.count * sizeof(InstanceData), 0);
+    if (batch.indexVbo) rlDrawVertexArrayElementsInstanced(0, batch.indexCount, 0, batch.count);
+    else rlDrawVertexArrayInstanced(0, batch.vertexCount, batch.count);
+    rlDisableVertexArray();
+    rlDisableShader();
+
+    instanceDrawCalls++;
+    instancesDrawn += batch.count;
+    batch.count = 0;
+}
+
+void DrawInstance(InstanceBatch& batch, Vector3 center, float size, Color color) {
+    if (!batch.ready) {
+        if (batch.shape == INSTANCE_SPHERE) DrawSphere(center, size, color);
+        else DrawCube(center, size, size, size, color);
+        return;
+    }
+    if (batch.count == MAX_INSTANCES) FlushInstances(batch);
+    batch.instances[batch.count++] = {center.x, center.y, center.z, size,
+                                      color.r, color.g, color.b, color.a};
+}
+
+void ResetInstanceStats() {
+    instanceDrawCalls = 0;
+    instancesDrawn = 0;
+}
+
+// ======================================================================
+// Static Geometry
+// ======================================================================
+// Pillars (including the border ring) never move once ResetLevel() has laid
+// them out, so BuildStaticGeometry() bakes them into one vertex-coloured mesh
+// per STATIC_CHUNK_SIZE square of the arena, and Draw3DScene() issues one
+// DrawMesh per chunk that survives a frustum test instead of two immediate-
+// mode DrawCube calls per pillar. The exit portal frame gets its own mesh so
+// its colour can follow exitActive through the material tint. Boxes use
+// eight shared corners and no normals, which matches DrawCube's unlit look.
+// In HEADLESS, or before InitStaticGeometry(), the immediate path is used.
+const float STATIC_CHUNK_SIZE = 40.0f;
+const int STATIC_CHUNK_DIM = 5;            // Covers +-100, past the border pillars
+const int STATIC_CHUNK_COUNT = STATIC_CHUNK_DIM * STATIC_CHUNK_DIM;
+
+struct StaticChunk {
+    Mesh mesh = {};
+    BoundingBox bounds = {};
+    int boxes = 0;
+};
+
+struct StaticGeometry {
+    bool ready = false;
+    Material material = {};
+    StaticChunk chunks[STATIC_CHUNK_COUNT];
+    StaticChunk portal;
+    int chunksDrawn = 0;                   // Last frame, for the debug overlay
+    int chunksBuilt = 0;
+};
+StaticGeometry staticGeometry;
+
+// CPU-side arrays for one mesh while it is being assembled
+struct MeshBuilder {
+    std::vector<float> vertices;
+    std::vector<unsigned char> colors;
+    std::vector<unsigned short> indices;
+    BoundingBox bounds = {{1e9f, 1e9f, 1e9f}, {-1e9f, -1e9f, -1e9f}};
+};
+
+// Returns the new vertex's index
+unsigned short AppendVertex(MeshBuilder& b, Vector3 v, Color color) {
+    b.vertices.insert(b.vertices.end(), {v.x, v.y, v.z});
+    b.colors.insert(b.colors.end(), {color.r, color.g, color.b, color.a});
+    b.bounds.min = Vector3Min(b.bounds.min, v);
+    b.bounds.max = Vector3Max(b.bounds.max, v);
+    return (unsigned short)(b.vertices.size() / 3 - 1);
+}
+
+// Box with DrawCube's centre + full-extent convention, wound CCW from outside
+void AppendBox(MeshBuilder& b, Vector3 center, Vector3 size, Color color) {
+    unsigned short base = (unsigned short)(b.vertices.size() / 3);
+    for (int corner = 0; corner < 8; corner++) {
+        AppendVertex(b, {center.x + ((corner & 1) ? 0.5f : -0.5f) * size.x,
+                         center.y + ((corner & 2) ? 0.5f : -0.5f) * size.y,
+                         center.z + ((corner & 4) ? 0.5f : -0.5f) * size.z}, color);
+    }
+    // Face on axis k: corners (0,0),(1,0),(1,1),(0,1) over the next two axes
+    // wind around +k, so the low face takes them in reverse
+    for (int k = 0; k < 3; k++) {
+        int u = 1 << ((k + 1) % 3), v = 1 << ((k + 2) % 3);
+        for (int side = 0; side < 2; side++) {
+            int s = side ? (1 << k) : 0;
+            unsigned short q[4] = {(unsigned short)(base + s), (unsigned short)(base + s + u),
+                                   (unsigned short)(base + s + u + v), (unsigned short)(base + s + v)};
+            if (!side) std::swap(q[1], q[3]);
+            b.indices.insert(b.indices.end(), {q[0], q[1], q[2], q[0], q[2], q[3]});
+        }
+    }
+}
+
+// Copies the arrays into a raylib-owned Mesh and uploads it
+Mesh UploadBuilderMesh(const MeshBuilder& b) {
+    Mesh m = {};
+    m.vertexCount = (int)(b.vertices.size() / 3);
+    m.triangleCount = (int)(b.indices.size() / 3);
+    m.vertices = (float*)MemAlloc(b.vertices.size() * sizeof(float));
+    m.colors = (unsigned char*)MemAlloc(b.colors.size());
+    m.indices = (unsigned short*)MemAlloc(b.indices.size() * sizeof(unsigned short));
+    std::copy(b.vertices.begin(), b.vertices.end(), m.vertices);
+    std::copy(b.colors.begin(), b.colors.end(), m.colors);
+    std::copy(b.indices.begin(), b.indices.end(), m.indices);
+    UploadMesh(&m, false);
+    return m;
+}
+
+StaticChunk FinishChunk(const MeshBuilder& b, int boxes) {
+    StaticChunk chunk;
+    chunk.boxes = boxes;
+    chunk.bounds = b.bounds;
+    chunk.mesh = UploadBuilderMesh(b);
+    return chunk;
+}
+
+void ReleaseChunk(StaticChunk& chunk) {
+    if (chunk.boxes) UnloadMesh(chunk.mesh);
+    chunk = {};
+}
+
+void UnloadStaticGeometry() {
+    for (auto& chunk : staticGeometry.chunks) ReleaseChunk(chunk);
+    ReleaseChunk(staticGeometry.portal);
+    staticGeometry.chunksBuilt = 0;
+}
+
+void InitStaticGeometry() {
+    staticGeometry.material = LoadMaterialDefault();
+    staticGeometry.ready = true;
+}
+
+int StaticChunkIndex(Vector3 pos) {
+    int cx = std::clamp((int)floorf(pos.x / STATIC_CHUNK_SIZE) + STATIC_CHUNK_DIM / 2, 0, STATIC_CHUNK_DIM - 1);
+    int cz = std::clamp((int)floorf(pos.z / STATIC_CHUNK_SIZE) + STATIC_CHUNK_DIM / 2, 0, STATIC_CHUNK_DIM - 1);
+    return cz * STATIC_CHUNK_DIM + cx;
+}
+
+// Called at the end of ResetLevel(), once obstacles and exitPosition are final
+void BuildStaticGeometry() {
+    if (!staticGeometry.ready) return;
+    UnloadStaticGeometry();
+
+    MeshBuilder builders[STATIC_CHUNK_COUNT];
+    int boxes[STATIC_CHUNK_COUNT] = {};
+    for (const auto& obs : obstacles) {
+        int c = StaticChunkIndex(obs);
+        AppendBox(builders[c], obs, {8.0f, 16.0f, 8.0f}, DARKGRAY);
+        AppendBox(builders[c], Vector3Add(obs, {0, 9.0f, 0}), {6.0f, 2.0f, 6.0f}, GRAY);
+        boxes[c] += 2;
+    }
+    for (int c = 0; c < STATIC_CHUNK_COUNT; c++) {
+        if (!boxes[c]) continue;
+        staticGeometry.chunks[c] = FinishChunk(builders[c], boxes[c]);
+        staticGeometry.chunksBuilt++;
+    }
+
+    if (currentLevel == 1) {
+        MeshBuilder portal;
+        AppendBox(portal, Vector3Add(exitPosition, {0, 6.0f, 0}), {10.0f, 12.0f, 4.0f}, WHITE);
+        staticGeometry.portal = FinishChunk(portal, 1);
+    }
+}
+
+// Conservative: false only when all eight corners are outside one clip plane
+bool BoxInFrustum(const BoundingBox& box, const Matrix& m) {
+    int outside[6] = {};
+    for (int corner = 0; corner < 8; corner++) {
+        float x = (corner & 1) ? box.max.x : box.min.x;
+        float y = (corner & 2) ? box.max.y : box.min.y;
+        float z = (corner & 4) ? box.max.z : box.min.z;
+        float cx = m.m0*x + m.m4*y + m.m8*z + m.m12;
+        float cy = m.m1*x + m.m5*y + m.m9*z + m.m13;
+        float cz = m.m2*x + m.m6*y + m.m10*z + m.m14;
+        float cw = m.m3*x + m.m7*y + m.m11*z + m.m15;
+        outside[0] += cx < -cw; outside[1] += cx > cw;
+        outside[2] += cy < -cw; outside[3] += cy > cw;
+        outside[4] += cz < -cw; outside[5] += cz > cw;
+    }
+    for (int plane = 0; plane < 6; plane++) if (outside[plane] == 8) return false;
+    return true;
+}
+
+// Inside BeginMode3D. Returns false when nothing is baked (immediate path).
+bool DrawStaticGeometry() {
+    staticGeometry.chunksDrawn = 0;
+    if (!staticGeometry.ready || !staticGeometry.chunksBuilt) return false;
+    Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+    for (const auto& chunk : staticGeometry.chunks) {
+        if (!chunk.boxes || !BoxInFrustum(chunk.bounds, mvp)) continue;
+        DrawMesh(chunk.mesh, staticGeometry.material, MatrixIdentity());
+        staticGeometry.chunksDrawn++;
+    }
+    return true;
+}
+
+// Translucent, so drawn after the opaque chunks
+void DrawPortalFrame(Color tint) {
+    if (!staticGeometry.portal.boxes) {
+        DrawCube(Vector3Add(exitPosition, {0,6.0f,0}), 10.0f, 12.0f, 4.0f, tint);
+        return;
+    }
+    staticGeometry.material.maps[MATERIAL_MAP_DIFFUSE].color = tint;
+    DrawMesh(staticGeometry.portal.mesh, staticGeometry.material, MatrixIdentity());
+    staticGeometry.material.maps[MATERIAL_MAP_DIFFUSE].color = WHITE;
+}
+
+// ======================================================================
+// Function Prototypes
+// ======================================================================
+void InitGame();
+void ResetLevel();
+bool UpdateFrame(float frameTime);
+void DrawFrame();
+void PollInput();
+void ClearInputEdges();
+void SaveInterpolationState();
+bool StepSimulation();
+void UpdateGame(float dt);
+void UpdatePlayer(float dt);
+void UpdateEnemies(float dt);
+void UpdateParticles(float dt);
+void UpdateCamera(float dt);
+void Draw3DScene();
+void DrawPlayer();
+void DrawEnemy(const Enemy& e, int index);
+void DrawHUD();
+void DrawTitleScreen();
+void DrawDeathScreen();
+void DrawVictoryScreen();
+void SpawnBloodParticles(Vector3 pos, int count = 12);
+void SpawnHitSparks(Vector3 pos, int count = 8);
+void AddWeaponTrailPoint(float dt);
+bool CanSeePlayer(const Enemy& e);
+bool IsEnemyAttackSwingHittingPlayer(const Enemy& e);
+void ApplyEnemyHitToPlayer(const Enemy& e);
+bool CheckPlayerAttackHitEnemy(Enemy& e);
+float LerpAngle(float from, float to, float t);
+
+// ======================================================================
+// Live Stats API
+// ======================================================================
+// game_get_stats() is exported to the page (Module._game_get_stats) and
+// returns a pointer to a GameStats in the wasm heap, which the shell reads as
+// 32-bit words. The game loop and the page's polling both run on the browser
+// main thread, so a read never sees a half-written frame. Field order is part
+// of the contract: keep it in sync with STATS_FIELDS in game_shell.html and
+// wasm_loader.html, and bump STATS_VERSION when it changes.
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+
+const int STATS_VERSION = 2;
+const int STATS_HISTORY = 240;  // Frame times behind the percentiles (~4 s)
+
+// Identical in every game; counters ashes has no use for (bullets, effect
+// queue) stay 0
+struct GameStats {
+    uint32_t version;
+    uint32_t frames;
+    float frameMsP50, frameMsP95, frameMsP99, frameMsMax;
+    float simMs, drawMs;  // Last frame
+    int32_t liveEnemies, liveBullets, liveParticles;
+    int32_t peakEnemies, peakBullets, peakParticles;  // Session high-water marks
+    int32_t effectQueueDepth, effectQueuePeak;
+    int32_t qualityTier;  // Index into QUALITY_TIERS, 0 = HIGH
+};
+
+struct StatsRecorder {
+    GameStats out = {};
+    float frameMs[STATS_HISTORY] = {};
+    double frameStart = 0.0;
+    double markTime = 0.0;
+};
+StatsRecorder stats;
+
+// Top of each rendered frame: closes the previous frame's wall time
+void StatsBeginFrame() {
+    double now = GetTime();
+    if (stats.frameStart > 0.0) {
+        stats.frameMs[stats.out.frames % STATS_HISTORY] = (float)((now - stats.frameStart) * 1000.0);
+        stats.out.frames++;
+    }
+    stats.frameStart = stats.markTime = now;
+}
+
+// Milliseconds since the last begin/lap
+float StatsLap() {
+    double now = GetTime();
+    float ms = (float)((now - stats.markTime) * 1000.0);
+    stats.markTime = now;
+    return ms;
+}
+
+void StatsEndSim() { stats.out.simMs = StatsLap(); }
+
+void StatsEndDraw() {
+    stats.out.drawMs = StatsLap();
+    int alive = 0;
+    for (const auto& e : enemies) if (e.alive) alive++;
+    stats.out.liveEnemies = alive;
+    stats.out.liveParticles = particles.count;
+    stats.out.peakEnemies = std::max(stats.out.peakEnemies, alive);
+    stats.out.peakParticles = particles.peakCount;
+}
+
+// ======================================================================
+// Quality Governor
+// ======================================================================
+// Trades visual budget for frame time on slow machines. Each rendered frame
+// feeds its wall time into a rolling window; when the window's mean runs over
+// QUALITY_DEGRADE_MS the governor drops one tier, and it only climbs back
+// after the mean has stayed under the lower QUALITY_UPGRADE_MS for a hold
+// period. An upgrade that is reverted within QUALITY_REVERT_WINDOW doubles
+// the next hold, so a machine sitting on the edge settles instead of
+// flickering between tiers. Tiers only touch cosmetics (particle counts,
+// trail length, sphere tessellation), never the fixed-step simulation, and the
+// HEADLESS build never feeds it.
+struct QualityTier {
+    const char* name;
+    float particleScale;            // Per-hit particle counts and ambient ash odds
+    float trailLife;                // Seconds a weapon trail sample stays visible
+    int sphereRings, sphereSlices;  // Actor spheres (raylib's DrawSphere is 16x16)
+};
+
+const QualityTier QUALITY_TIERS[] = {
+    {"HIGH",   1.00f, 0.50f, 16, 16},
+    {"MEDIUM", 0.60f, 0.35f, 10, 12},
+    {"LOW",    0.30f, 0.20f,  6,  8},
+};
+const int QUALITY_TIER_COUNT = sizeof(QUALITY_TIERS) / sizeof(QUALITY_TIERS[0]);
+const int QUALITY_WINDOW = 90;                // Frames in the rolling mean (~1.5 s)
+const float QUALITY_DEGRADE_MS = 19.0f;       // ~52 fps
+const float QUALITY_UPGRADE_MS = 17.5f;       // ~57 fps
+const float QUALITY_SAMPLE_CAP_MS = 100.0f;   // A single hitch can't trip a tier alone
+const float QUALITY_UPGRADE_HOLD = 4.0f;      // Seconds under the upgrade threshold
+const float QUALITY_UPGRADE_HOLD_MAX = 64.0f;
+const float QUALITY_REVERT_WINDOW = 10.0f;    // Seconds after an upgrade that count as a revert
+
+struct QualityGovernor {
+    float samples[QUALITY_WINDOW] = {};
+    float sum = 0.0f;
+    int count = 0;
+    int head = 0;
+    int tier = 0;
+    float calm = 0.0f;          // Seconds the mean has stayed under QUALITY_UPGRADE_MS
+    float sinceChange = 0.0f;
+    bool lastWasUpgrade = false;
+    float upgradeHold = QUALITY_UPGRADE_HOLD;
+};
+QualityGovernor quality;
+
+const QualityTier& Quality() { return QUALITY_TIERS[quality.tier]; }
+
+// Scales a per-event particle count, keeping at least one
+int QualityParticles(int count) {
+    return std::max(1, (int)(count * Quality().particleScale + 0.5f));
+}
+
+void QualitySetTier(int tier) {
+    quality.lastWasUpgrade = tier < quality.tier;
+    quality.tier = tier;
+    quality.count = quality.head = 0;   // Judge the new tier on its own frames
+    quality.sum = quality.calm = quality.sinceChange = 0.0f;
+    TraceLog(LOG_INFO, "Quality tier: %s", Quality().name);
+}
+
+void QualityObserve(float frameMs) {
+    float ms = std::min(frameMs, QUALITY_SAMPLE_CAP_MS);
+    if (quality.count == QUALITY_WINDOW) quality.sum -= quality.samples[quality.head];
+    else quality.count++;
+    quality.samples[quality.head] = ms;
+    quality.sum += ms;
+    quality.head = (quality.head + 1) % QUALITY_WINDOW;
+    quality.sinceChange += ms / 1000.0f;
+    if (quality.count < QUALITY_WINDOW) return;
+
+    float mean = quality.sum / quality.count;
+    if (mean > QUALITY_DEGRADE_MS) {
+        if (quality.tier == QUALITY_TIER_COUNT - 1) return;
+        if (quality.lastWasUpgrade && quality.sinceChange < QUALITY_REVERT_WINDOW)
+            quality.upgradeHold = std::min(quality.upgradeHold * 2.0f, QUALITY_UPGRADE_HOLD_MAX);
+        QualitySetTier(quality.tier + 1);
+    } else if (mean < QUALITY_UPGRADE_MS && quality.tier > 0) {
+        quality.calm += ms / 1000.0f;
+        if (quality.calm >= quality.upgradeHold) QualitySetTier(quality.tier - 1);
+    } else {
+        quality.calm = 0.0f;
+    }
+}
+
+// DrawSphere with the current tier's tessellation
+void DrawQualitySphere(Vector3 center, float radius, Color color) {
+    DrawSphereEx(center, radius, Quality().sphereRings, Quality().sphereSlices, color);
+}
+
+extern "C" EMSCRIPTEN_KEEPALIVE const GameStats* game_get_stats() {
+    int n = std::min<int>(stats.out.frames, STATS_HISTORY);
+    float sorted[STATS_HISTORY];
+    std::copy(stats.frameMs, stats.frameMs + n, sorted);
+    std::sort(sorted, sorted + n);
+    auto pct = [&](float p) { return n ? sorted[std::min(n - 1, (int)(p * n))] : 0.0f; };
+    stats.out.version = STATS_VERSION;
+    stats.out.frameMsP50 = pct(0.50f);
+    stats.out.frameMsP95 = pct(0.95f);
+    stats.out.frameMsP99 = pct(0.99f);
+    stats.out.frameMsMax = n ? sorted[n - 1] : 0.0f;
+    stats.out.qualityTier = quality.tier;
+    return &stats.out;
+}
+
+// ======================================================================
+// Character Meshes
+// ======================================================================
+// The player and every enemy archetype are a handful of rigid primitives
+// hung off at most four frames: the body root, the player's parry arm, the
+// weapon and the tank's shield. InitCharacterMeshes() bakes each frame's
+// primitives once into a vertex-coloured mesh (one set per quality tier, so
+// actor spheres still follow the governor) instead of re-tessellating every
+// cylinder and sphere in immediate mode each frame. Primitives that take a
+// per-frame colour (stun/block flashes, the blade) are baked white into a
+// separate tinted layer. Drawing an actor only queues one transform per
+// frame and layer; FlushCharacterParts() then issues one instanced draw per
+// queue, shared by every enemy of that archetype. Without the instancing
+// shader or VAOs the same meshes go through DrawMesh with a material tint.
+const int CHARACTER_MAX_INSTANCES = 256;   // Per draw; longer queues go in slices
+const int PART_ATTRIB_COLOR = 3;           // Must match the layout() in the shader
+const int PART_ATTRIB_TRANSFORM = 8;       // mat4 takes four slots, 8..11
+const int PART_ATTRIB_TINT = 12;
+const float BLADE_THICKNESS = 0.18f;       // Player greatblade cross-section
+const float BLADE_BASE_WIDTH = 1.3f;
+const float BLADE_TIP_WIDTH = 0.7f;
+
+const char* const PART_VS = INSTANCE_GLSL_VERSION R"(
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 3) in vec4 vertexColor;
+layout(location = 8) in mat4 instanceTransform;
+layout(location = 12) in vec4 instanceTint;
+uniform mat4 viewProj;
+out vec4 fragColor;
+void main() {
+    fragColor = vertexColor * instanceTint;
+    gl_Position = viewProj * instanceTransform * vec4(vertexPosition, 1.0);
+}
+)";
+
+enum CharacterRig { RIG_PLAYER, RIG_GRUNT, RIG_TANK, RIG_AGILE, RIG_BOSS, RIG_COUNT };
+enum RigFrame { FRAME_ROOT, FRAME_ARM, FRAME_WEAPON, FRAME_SHIELD, FRAME_COUNT };
+enum PartLayer { LAYER_FIXED, LAYER_TINTED, LAYER_COUNT };
+
+struct PartInstance {
+    float transform[16];        // Column-major, as the shader's mat4 reads it
+    unsigned char r, g, b, a;
+};
+
+struct CharacterPart {
+    Mesh mesh = {};
+    unsigned int vao = 0;       // Mesh buffers plus the shared instance buffer
+    int indexCount = 0;         // 0 when the frame has nothing on this layer
+};
+
+struct CharacterMeshes {
+    bool ready = false;
+    bool instanced = false;
+    Shader shader = {0};
+    int viewProjLoc = -1;
+    unsigned int instanceVbo = 0;
+    Material material = {};
+    float bladeLength = 0.0f;   // The player's blade is baked for this weapon length
+    CharacterPart parts[QUALITY_TIER_COUNT][RIG_COUNT][FRAME_COUNT][LAYER_COUNT];
+    std::vector<PartInstance> queued[RIG_COUNT][FRAME_COUNT][LAYER_COUNT];
+};
+CharacterMeshes characterMeshes;
+
+CharacterRig EnemyRig(EnemyType type) { return (CharacterRig)(RIG_GRUNT + (int)type); }
+
+// Matches DrawSphereEx's rings + 2 latitude bands, wound CCW from outside
+void AppendSphere(MeshBuilder& b, Vector3 center, float radius, int rings, int slices, Color color) {
+    int bands = rings + 2;
+    unsigned short base = (unsigned short)(b.vertices.size() / 3);
+    for (int i = 0; i <= bands; i++) {
+        float theta = PI * i / bands;
+        for (int j = 0; j <= slices; j++) {
+            float phi = 2.0f * PI * j / slices;
+            AppendVertex(b, {center.x + radius * sinf(theta) * cosf(phi),
+                             center.y + radius * cosf(theta),
+                             center.z + radius * sinf(theta) * sinf(phi)}, color);
+        }
+    }
+    for (int i = 0; i < bands; i++) {
+        for (int j = 0; j < slices; j++) {
+            unsigned short a = (unsigned short)(base + i * (slices + 1) + j);
+            unsigned short c = (unsigned short)(a + slices + 1);
+            b.indices.insert(b.indices.end(), {a, (unsigned short)(a + 1), (unsigned short)(c + 1),
+                                               a, (unsigned short)(c + 1), c});
+        }
+    }
+}
+
+// DrawCylinderEx equivalent: tapered tube from start to end with capped ends
+void AppendCylinder(MeshBuilder& b, Vector3 start, Vector3 end, float startRadius, float endRadius,
+                    int sides, Color color) {
+    Vector3 axis = Vector3Normalize(Vector3Subtract(end, start));
+    Vector3 ref = (fabsf(axis.y) < 0.99f) ? Vector3{0, 1, 0} : Vector3{1, 0, 0};
+    Vector3 u = Vector3Normalize(Vector3CrossProduct(axis, ref));
+    Vector3 v = Vector3CrossProduct(axis, u);
+    unsigned short startCenter = AppendVertex(b, start, color);
+    unsigned short endCenter = AppendVertex(b, end, color);
+    unsigned short base = (unsigned short)(b.vertices.size() / 3);
+    for (int k = 0; k < sides; k++) {
+        float phi = 2.0f * PI * k / sides;
+        Vector3 dir = Vector3Add(Vector3Scale(u, cosf(phi)), Vector3Scale(v, sinf(phi)));
+        AppendVertex(b, Vector3Add(start, Vector3Scale(dir, startRadius)), color);
+        AppendVertex(b, Vector3Add(end, Vector3Scale(dir, endRadius)), color);
+    }
+    for (int k = 0; k < sides; k++) {
+        unsigned short s0 = (unsigned short)(base + 2 * k), e0 = (unsigned short)(s0 + 1);
+        unsigned short s1 = (unsigned short)(base + 2 * ((k + 1) % sides)), e1 = (unsigned short)(s1 + 1);
+        b.indices.insert(b.indices.end(), {s0, s1, e1, s0, e1, e0});
+        if (startRadius > 0.0f) b.indices.insert(b.indices.end(), {startCenter, s1, s0});
+        if (endRadius > 0.0f) b.indices.insert(b.indices.end(), {endCenter, e0, e1});
+    }
+}
+
+// Every primitive the old immediate-mode DrawPlayer/DrawEnemy issued, in the
+// same frame-local coordinates. Tinted primitives are WHITE (keeping their
+// Fade alpha) and pick up the actor's colour at draw time. The player's blade
+// depends on the weapon, so AppendPlayerBlade() adds it separately.
+void BuildRig(CharacterRig rig, const QualityTier& q, MeshBuilder (&out)[FRAME_COUNT][LAYER_COUNT]) {
+    MeshBuilder& body = out[FRAME_ROOT][LAYER_FIXED];
+    MeshBuilder& skin = out[FRAME_ROOT][LAYER_TINTED];
+    MeshBuilder& weapon = out[FRAME_WEAPON][LAYER_FIXED];
+    auto sphere = [&](MeshBuilder& b, Vector3 c, float r, Color col) {
+        AppendSphere(b, c, r, q.sphereRings, q.sphereSlices, col);
+    };
+
+    if (rig == RIG_BOSS) {
+        Color hide = {200, 40, 60, 255};
+        AppendBox(body, {0, 1.2f, 0}, {2.4f, 3.8f, 1.8f}, hide);
+        sphere(body, {0, 3.8f, 0}, 0.9f, hide);
+        AppendCylinder(body, {0, 3.8f, 0}, {0, 5.2f, 0}, 1.1f, 0.7f, 16, DARKGRAY);
+        AppendCylinder(body, {-0.8f, 4.2f, 0}, {-1.4f, 5.8f, 0}, 0.3f, 0.1f, 8, GRAY);
+        AppendCylinder(body, {0.8f, 4.2f, 0}, {1.4f, 5.8f, 0}, 0.3f, 0.1f, 8, GRAY);
+        AppendBox(body, {0, 1.8f, -0.8f}, {2.6f, 3.8f, 0.3f}, Fade(RED, 0.8f));
+    } else {
+        AppendCylinder(body, {-0.4f, -0.9f, 0}, {-0.4f, 1.0f, 0}, 0.5f, 0.4f, 12, DARKGRAY);
+        AppendCylinder(body, { 0.4f, -0.9f, 0}, { 0.4f, 1.0f, 0}, 0.5f, 0.4f, 12, DARKGRAY);
+        AppendBox(skin, {0, 0.9f, 0}, {1.7f, 2.9f, 1.3f}, WHITE);
+        if (rig == RIG_PLAYER) {
+            sphere(body, {-0.4f, -0.9f, 0}, 0.52f, DARKGRAY);
+            sphere(body, { 0.4f, -0.9f, 0}, 0.52f, DARKGRAY);
+            AppendBox(skin, {0, 1.1f, 0.45f}, {1.9f, 2.2f, 0.5f}, Fade(WHITE, 0.7f));
+            sphere(skin, {-1.0f, 1.9f, 0}, 0.55f, WHITE);
+            sphere(skin, { 1.0f, 1.9f, 0}, 0.55f, WHITE);
+        }
+        sphere(skin, {0, 2.4f, 0}, 0.62f, Fade(WHITE, 0.9f));
+
+        if (rig == RIG_PLAYER) {
+            AppendCylinder(body, {0, 2.4f, 0}, {0, 3.1f, 0}, 0.75f, 0.55f, 16, DARKGRAY);
+        } else if (rig == RIG_GRUNT) {
+            AppendCylinder(body, {0, 2.4f, 0}, {0, 3.1f, 0}, 0.75f, 0.55f, 16, MAROON);
+            AppendCylinder(body, {0, 3.3f, 0}, {0, 4.2f, 0}, 0.3f, 0.0f, 8, RED);
+        } else if (rig == RIG_TANK) {
+            AppendBox(body, {0, 2.7f, 0}, {1.5f, 1.8f, 1.5f}, DARKGRAY);
+        } else if (rig == RIG_AGILE) {
+            AppendCylinder(body, {0, 2.4f, 0}, {0, 3.6f, 0}, 0.85f, 0.55f, 16, DARKGREEN);
+        }
+    }
+
+    if (rig == RIG_PLAYER) {
+        // Parry arm, hanging from the shoulder pivot
+        AppendCylinder(out[FRAME_ARM][LAYER_TINTED], {0, 0, 0}, {0, -1.4f, 0}, 0.35f, 0.3f, 12, WHITE);
+        sphere(out[FRAME_ARM][LAYER_FIXED], {0, -1.4f, 0}, 0.38f, DARKGRAY);
+
+        AppendCylinder(weapon, {0, -0.4f, 0}, {0, -1.4f, 0}, 0.22f, 0.22f, 16, {139, 69, 19, 255});
+        sphere(weapon, {0, -1.6f, 0}, 0.35f, GRAY);
+        AppendBox(weapon, {0, -0.2f, 0}, {0.5f, 0.4f, 1.0f}, GRAY);
+        AppendCylinder(weapon, {-1.4f, -0.2f, 0}, {1.4f, -0.2f, 0}, 0.28f, 0.28f, 12, GRAY);
+    } else {
+        float bladeLen = (rig == RIG_BOSS) ? 9.5f : 5.8f;
+        AppendCylinder(weapon, {0, -0.3f, 0}, {0, -1.0f, 0}, 0.18f, 0.18f, 12, BROWN);
+        AppendCylinder(weapon, {-0.9f, -0.1f, 0}, {0.9f, -0.1f, 0}, 0.22f, 0.22f, 10, GRAY);
+        AppendBox(weapon, {0, 0.0f, 2.9f}, {0.14f, 0.7f, bladeLen}, LIGHTGRAY);
+    }
+
+    if (rig == RIG_TANK) {
+        float height = 3.8f;
+        float width = 2.0f;
+        float thick = 0.4f;
+        MeshBuilder& shield = out[FRAME_SHIELD][LAYER_FIXED];
+        AppendBox(out[FRAME_SHIELD][LAYER_TINTED], {0, 0, 0}, {width, height, thick}, Fade(WHITE, 0.8f));
+        AppendBox(shield, {0, 0, thick/2 + 0.08f}, {width + 0.3f, height + 0.3f, 0.15f}, DARKGRAY);
+        AppendCylinder(shield, {0, 0, thick/2 + 0.1f}, {0, 2.0f, thick/2 + 0.1f}, 0.25f, 0.55f, 20, GRAY);
+        AppendBox(shield, {0, 0.9f, thick/2 + 0.15f}, {0.25f, 1.8f, 0.1f}, GOLD);
+        AppendBox(shield, {0, 0, thick/2 + 0.15f}, {1.4f, 0.25f, 0.1f}, GOLD);
+    }
+}
+
+void AppendPlayerBlade(MeshBuilder& b, float length) {
+    AppendBox(b, {0, 0.0f, length * 0.4f}, {BLADE_THICKNESS, BLADE_BASE_WIDTH, length * 0.8f}, WHITE);
+    AppendBox(b, {0, 0.0f, length - BLADE_TIP_WIDTH * 0.4f},
+              {BLADE_THICKNESS, BLADE_TIP_WIDTH, length * 0.4f}, WHITE);
+    AppendBox(b, {0, 0.04f, length * 0.5f},
+              {BLADE_THICKNESS * 0.6f, BLADE_BASE_WIDTH * 0.55f, length * 0.9f}, Fade(WHITE, 0.7f));
+}
+
+void ReleasePart(CharacterPart& part) {
+    if (!part.indexCount) return;
+    if (part.vao) rlUnloadVertexArray(part.vao);
+    UnloadMesh(part.mesh);
+    part = {};
+}
+
+void FinishPart(CharacterPart& part, const MeshBuilder& b) {
+    ReleasePart(part);
+    if (b.indices.empty()) return;
+    part.mesh = UploadBuilderMesh(b);
+    part.indexCount = (int)b.indices.size();
+    if (!characterMeshes.instanced) return;
+
+    // Second VAO over the mesh's own buffers, plus the per-instance stream
+    part.vao = rlLoadVertexArray();
+    if (part.vao == 0) {
+        characterMeshes.instanced = false;
+        return;
+    }
+    rlEnableVertexArray(part.vao);
+    rlEnableVertexBuffer(part.mesh.vboId[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION]);
+    rlSetVertexAttribute(0, 3, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(0);
+    rlEnableVertexBuffer(part.mesh.vboId[RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR]);
+    rlSetVertexAttribute(PART_ATTRIB_COLOR, 4, RL_UNSIGNED_BYTE, true, 0, 0);
+    rlEnableVertexAttribute(PART_ATTRIB_COLOR);
+    rlEnableVertexBufferElement(part.mesh.vboId[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES]);
+
+    rlEnableVertexBuffer(characterMeshes.instanceVbo);
+    for (int column = 0; column < 4; column++) {
+        rlSetVertexAttribute(PART_ATTRIB_TRANSFORM + column, 4, RL_FLOAT, false, sizeof(PartInstance),
+                             column * 4 * sizeof(float));
+        rlEnableVertexAttribute(PART_ATTRIB_TRANSFORM + column);
+        rlSetVertexAttributeDivisor(PART_ATTRIB_TRANSFORM + column, 1);
+    }
+    rlSetVertexAttribute(PART_ATTRIB_TINT, 4, RL_UNSIGNED_BYTE, true, sizeof(PartInstance),
+                         offsetof(PartInstance, r));
+    rlEnableVertexAttribute(PART_ATTRIB_TINT);
+    rlSetVertexAttributeDivisor(PART_ATTRIB_TINT, 1);
+    rlDisableVertexArray();
+}
+
+void InitCharacterMeshes() {
+    characterMeshes.material = LoadMaterialDefault();
+    characterMeshes.shader = LoadShaderFromMemory(PART_VS, INSTANCE_FS);
+    if (characterMeshes.shader.id != rlGetShaderIdDefault()) {
+        characterMeshes.viewProjLoc = GetShaderLocation(characterMeshes.shader, "viewProj");
+        characterMeshes.instanceVbo = rlLoadVertexBuffer(nullptr, CHARACTER_MAX_INSTANCES * sizeof(PartInstance), true);
+        characterMeshes.instanced = characterMeshes.instanceVbo != 0;
+    }
+
+    for (int tier = 0; tier < QUALITY_TIER_COUNT; tier++) {
+        for (int rig = 0; rig < RIG_COUNT; rig++) {
+            MeshBuilder layers[FRAME_COUNT][LAYER_COUNT];
+            BuildRig((CharacterRig)rig, QUALITY_TIERS[tier], layers);
+            for (int frame = 0; frame < FRAME_COUNT; frame++)
+                for (int layer = 0; layer < LAYER_COUNT; layer++)
+                    FinishPart(characterMeshes.parts[tier][rig][frame][layer], layers[frame][layer]);
+        }
+    }
+    characterMeshes.ready = true;
+}
+
+// Rebakes the player's tinted weapon layer when the weapon length changes
+void BakePlayerBlade(float length) {
+    MeshBuilder blade;
+    AppendPlayerBlade(blade, length);
+    for (int tier = 0; tier < QUALITY_TIER_COUNT; tier++)
+        FinishPart(characterMeshes.parts[tier][RIG_PLAYER][FRAME_WEAPON][LAYER_TINTED], blade);
+    characterMeshes.bladeLength = length;
+}
 
-// ======================================================================
-// Function Prototypes
-// ======================================================================
-void InitGame();
-void ResetLevel();
-void UpdateGame(float dt);
-void UpdatePlayer(float dt);
-void UpdateEnemies(float dt);
-void UpdateParticles(float dt);
-void UpdateCamera(float dt);
-void Draw3DScene();
-void DrawPlayer();
-void DrawEnemy(const Enemy& e, int index);
-void DrawHUD();
-void DrawTitleScreen();
-void DrawDeathScreen();
-void DrawVictoryScreen();
-void SpawnBloodParticles(Vector3 pos, int count = 12);
-void SpawnHitSparks(Vector3 pos, int count = 8);
-void AddWeaponTrailPoint();
-bool CanSeePlayer(const Enemy& e);
-bool IsEnemyAttackSwingHittingPlayer(const Enemy& e);
-void ApplyEnemyHitToPlayer(const Enemy& e);
-bool CheckPlayerAttackHitEnemy(Enemy& e);
+void UnloadCharacterMeshes() {
+    if (!characterMeshes.ready) return;
+    for (auto& tier : characterMeshes.parts)
+        for (auto& rig : tier)
+            for (auto& frame : rig)
+                for (auto& part : frame) ReleasePart(part);
+    if (characterMeshes.instanceVbo) rlUnloadVertexBuffer(characterMeshes.instanceVbo);
+    UnloadShader(characterMeshes.shader);
+    UnloadMaterial(characterMeshes.material);
+    characterMeshes.ready = false;
+}
+
+// Same composition as rlTranslatef(offset), rlRotatef(yaw, Y), rlRotatef(pitch, X) under parent
+Matrix SwingFrame(const Matrix& parent, Vector3 offset, float yawDeg, float pitchDeg) {
+    Matrix local = MatrixMultiply(MatrixMultiply(MatrixRotateX(pitchDeg * DEG2RAD), MatrixRotateY(yawDeg * DEG2RAD)),
+                                  MatrixTranslate(offset.x, offset.y, offset.z));
+    return MatrixMultiply(local, parent);
+}
+
+// Queues both layers of one rig frame; the fixed layer is drawn untinted
+void QueueRigFrame(CharacterRig rig, RigFrame frame, const Matrix& transform, Color tint) {
+    if (!characterMeshes.ready) return;
+    float16 m = MatrixToFloatV(transform);
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        if (!characterMeshes.parts[quality.tier][rig][frame][layer].indexCount) continue;
+        Color c = (layer == LAYER_TINTED) ? tint : WHITE;
+        PartInstance inst;
+        std::copy(m.v, m.v + 16, inst.transform);
+        inst.r = c.r; inst.g = c.g; inst.b = c.b; inst.a = c.a;
+        characterMeshes.queued[rig][frame][layer].push_back(inst);
+    }
+}
+
+// Inside BeginMode3D; one draw per non-empty (rig, frame, layer) queue
+void FlushCharacterParts() {
+    if (!characterMeshes.ready) return;
+    rlDrawRenderBatchActive();  // Keep draw order with the immediate-mode geometry
+
+    if (characterMeshes.instanced) {
+        Matrix modelView = MatrixMultiply(rlGetMatrixTransform(), rlGetMatrixModelview());
+        rlEnableShader(characterMeshes.shader.id);
+        rlSetUniformMatrix(characterMeshes.viewProjLoc, MatrixMultiply(modelView, rlGetMatrixProjection()));
+    }
+    for (int rig = 0; rig < RIG_COUNT; rig++) {
+        for (int frame = 0; frame < FRAME_COUNT; frame++) {
+            for (int layer = 0; layer < LAYER_COUNT; layer++) {
+                auto& queue = characterMeshes.queued[rig][frame][layer];
+                if (queue.empty()) continue;
+                const CharacterPart& part = characterMeshes.parts[quality.tier][rig][frame][layer];
+                if (characterMeshes.instanced) {
+                    rlEnableVertexArray(part.vao);
+                    for (size_t first = 0; first < queue.size(); first += CHARACTER_MAX_INSTANCES) {
+                        int count = (int)std::min<size_t>(CHARACTER_MAX_INSTANCES, queue.size() - first);
+                        rlUpdateVertexBuffer(characterMeshes.instanceVbo, &queue[first], count * sizeof(PartInstance), 0);
+                        rlDrawVertexArrayElementsInstanced(0, part.indexCount, 0, count);
+                        instanceDrawCalls++;
+                        instancesDrawn += count;
+                    }
+                } else {
+                    for (const auto& inst : queue) {
+                        const float* t = inst.transform;
+                        Matrix transform = {t[0], t[4], t[8],  t[12],
+                                            t[1], t[5], t[9],  t[13],
+                                            t[2], t[6], t[10], t[14],
+                                            t[3], t[7], t[11], t[15]};
+                        characterMeshes.material.maps[MATERIAL_MAP_DIFFUSE].color = {inst.r, inst.g, inst.b, inst.a};
+                        DrawMesh(part.mesh, characterMeshes.material, transform);
+                    }
+                }
+                queue.clear();
+            }
+        }
+    }
+    if (characterMeshes.instanced) {
+        rlDisableVertexArray();
+        rlDisableShader();
+    } else {
+        characterMeshes.material.maps[MATERIAL_MAP_DIFFUSE].color = WHITE;
+    }
+}
 
 // ======================================================================
 // Main
 // ======================================================================
+#ifndef HEADLESS
 int main() {
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Echoes of the Feed – Ashes of the Scroll");
     SetTargetFPS(60);
     HideCursor();
     DisableCursor();
     InitAudioDevice();
+    InitInstanceBatch(sphereBatch, INSTANCE_SPHERE);
+    InitStaticGeometry();
+    InitCharacterMeshes();
+    SeedRandom((uint64_t)time(nullptr));
+    TraceLog(LOG_INFO, "RNG seed: %llu", (unsigned long long)rngSeed);
     InitGame();
 
     while (!WindowShouldClose()) {
-        float dt = GetFrameTime();
+        PROFILE_FRAME();
+        StatsBeginFrame();
+        QualityObserve(GetFrameTime() * 1000.0f);
+        if (!UpdateFrame(GetFrameTime())) break;
+        StatsEndSim();
+        DrawFrame();
+        StatsEndDraw();
+    }
 
-        if (gameState == TITLE_SCREEN) {
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsKeyPressed(KEY_ENTER)) {
-                currentLevel = 1;
-                gameState = PLAYING;
-                ResetLevel();
-            }
+    UnloadInstanceBatch(sphereBatch);
+    UnloadStaticGeometry();
+    UnloadMaterial(staticGeometry.material);
+    UnloadCharacterMeshes();
+    UnloadShader(instanceShader);
+    CloseAudioDevice();
+    CloseWindow();
+    return 0;
+}
+#endif
+
+// State machine and fixed-step simulation for one rendered frame.
+// Returns false when the player quits from the victory screen.
+bool UpdateFrame(float frameTime) {
+    PROFILE_ZONE("UpdateFrame");
+    frameTime = std::min(frameTime, MAX_FRAME_TIME);
+
+    if (gameState == TITLE_SCREEN) {
+        bool horde = IsKeyPressed(KEY_H);
+        if (horde || IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsKeyPressed(KEY_ENTER)) {
+            hordeMode = horde;
+            currentLevel = 1;
+            gameState = PLAYING;
+            ResetLevel();
         }
-        else if (gameState == PLAYING || gameState == PAUSED) {
-            if (IsKeyPressed(KEY_ESCAPE)) {
-                gameState = (gameState == PLAYING) ? PAUSED : PLAYING;
-            }
-            if (gameState == PLAYING) {
-                UpdateGame(dt);
-
-                // Level transition (only for level 1 → level 2)
-                if (currentLevel == 1 && exitActive && Vector3Distance(player.position, exitPosition) < 9.0f) {
-                    currentLevel = 2;
-                    ResetLevel();
-                }
-
-                // Death check
-                if (player.health <= 0 && !player.isDead) {
-                    player.isDead = true;
-                    player.deathTimer = 3.2f;
-                    player.deathFallAngle = 0.0f;
-                    gameState = DEAD;
-                    currentDeathMessage = deathMessages[GetRandomValue(0, (int)deathMessages.size()-1)].c_str();
-                }
-            }
+    }
+    else if (gameState == PLAYING || gameState == PAUSED) {
+        if (IsKeyPressed(KEY_ESCAPE)) {
+            gameState = (gameState == PLAYING) ? PAUSED : PLAYING;
         }
-        else if (gameState == DEAD) {
-            if (IsKeyPressed(KEY_R)) {
-                ResetLevel();
-                gameState = PLAYING;
+        if (gameState == PLAYING) {
+            // Fixed-step simulation, decoupled from the render rate
+            PollInput();
+            simAccumulator += frameTime;
+            int steps = 0;
+            while (simAccumulator >= SIM_DT && steps < MAX_SIM_STEPS &&
+                   gameState == PLAYING) {
+                // A level change zeroes the accumulator; nothing left to consume
+                if (StepSimulation()) break;
+                ClearInputEdges();
+                simAccumulator -= SIM_DT;
+                steps++;
             }
+            if (steps == MAX_SIM_STEPS) simAccumulator = std::min(simAccumulator, SIM_DT);
         }
-        else if (gameState == VICTORY) {
-            if (IsKeyPressed(KEY_ESCAPE)) break;
+    }
+    else if (gameState == DEAD) {
+        if (IsKeyPressed(KEY_R)) {
+            ResetLevel();
+            gameState = PLAYING;
         }
+    }
+    else if (gameState == VICTORY) {
+        if (IsKeyPressed(KEY_ESCAPE)) return false;
+    }
 
-        BeginDrawing();
-        ClearBackground({12, 12, 22, 255});
+    if (IsKeyPressed(KEY_F3)) showDebugOverlay = !showDebugOverlay;
 
-        BeginMode3D(camera);
-        Draw3DScene();
-        EndMode3D();
+    if (gameState != PLAYING) simAccumulator = 0.0f;
+    renderAlpha = (gameState == PLAYING) ? simAccumulator / SIM_DT : 1.0f;
+    return true;
+}
 
+void DrawFrame() {
+    PROFILE_ZONE("DrawFrame");
+    ResetInstanceStats();
+    BeginDrawing();
+    ClearBackground({12, 12, 22, 255});
+
+    Camera3D view = camera;
+    view.position = Vector3Lerp(prevCameraPosition, camera.position, renderAlpha);
+    view.target = Vector3Lerp(prevCameraTarget, camera.target, renderAlpha);
+    BeginMode3D(view);
+    Draw3DScene();
+    EndMode3D();
+
+    {
+        PROFILE_ZONE("DrawHUD");
         DrawHUD();
+    }
 
-        if (gameState == TITLE_SCREEN) DrawTitleScreen();
-        if (gameState == DEAD) DrawDeathScreen();
-        if (gameState == VICTORY) DrawVictoryScreen();
-        if (gameState == PAUSED) {
-            DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, Fade(BLACK, 0.65f));
-            DrawText("PAUSED", SCREEN_WIDTH/2 - MeasureText("PAUSED", 80)/2,
-                     SCREEN_HEIGHT/2 - 60, 80, GOLD);
-            DrawText("ESC to Resume", SCREEN_WIDTH/2 - MeasureText("ESC to Resume", 40)/2,
-                     SCREEN_HEIGHT/2 + 40, 40, LIGHTGRAY);
-        }
-
-        EndDrawing();
+    if (gameState == TITLE_SCREEN) DrawTitleScreen();
+    if (gameState == DEAD) DrawDeathScreen();
+    if (gameState == VICTORY) DrawVictoryScreen();
+    if (gameState == PAUSED) {
+        DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, Fade(BLACK, 0.65f));
+        DrawText("PAUSED", SCREEN_WIDTH/2 - MeasureText("PAUSED", 80)/2,
+                 SCREEN_HEIGHT/2 - 60, 80, GOLD);
+        DrawText("ESC to Resume", SCREEN_WIDTH/2 - MeasureText("ESC to Resume", 40)/2,
+                 SCREEN_HEIGHT/2 + 40, 40, LIGHTGRAY);
     }
 
-    CloseAudioDevice();
-    CloseWindow();
-    return 0;
+    PROFILE_OVERLAY();
+    PROFILE_ZONE("EndDrawing");  // Buffer swap; absorbs GPU and vsync waits
+    EndDrawing();
 }
 
 // ======================================================================
@@ -328,8 +1885,9 @@ void ResetLevel() {
     player.swingPitch = -30.0f;
 
     enemies.clear();
+    enemyMemory.clear();
     obstacles.clear();
-    particles.clear();
+    particles.Clear();
     weaponTrail.clear();
     hitStopTimer = 0.0f;
     exitActive = false;
@@ -345,98 +1903,58 @@ void ResetLevel() {
     }
 
     if (currentLevel == 1) {
-        // Random pillars in open field
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<float> dis(-border+15, border-15);
-        for (int i = 0; i < 90; i++) {
-            float x = dis(gen);
-            float z = dis(gen);
-            if (Vector3Distance({x,0,z}, {0,0,0}) > 18.0f) {
-                obstacles.push_back({x, 0, z});
-            }
-        }
-
-        // Enemies
-        const int MAX_ENEMIES = 14;
-        for (int i = 0; i < MAX_ENEMIES; i++) {
-            Vector3 pos;
-            bool valid = false;
-            int attempts = 0;
-            while (!valid && attempts < 60) {
-                attempts++;
-                float angle = GetRandomValue(0, 359) * DEG2RAD;
-                float dist = GetRandomValue(18, 75);
-                pos = { cosf(angle)*dist, 0, sinf(angle)*dist };
-                valid = Vector3Distance(pos, {0,0,0}) > 16.0f;
-                for (const auto& obs : obstacles) {
-                    if (Vector3Distance(pos, obs) < 9.0f) {
-                        valid = false;
-                        break;
-                    }
-                }
-            }
-            if (!valid) continue;
+        // The whole layout comes from the level's own stream, so it depends
+        // only on the seed: a restart or a benchmark rerun rebuilds it exactly
+        Rng layout = Rng::Stream(RNG_LEVEL, currentLevel);
+
+        // Pillars scattered over the open field, clear of the start
+        float field = (float)(border - 15);
+        levelSampler.Reset({-field, -field}, {field, field}, PILLAR_SPACING);
+        levelSampler.Fill(layout, [](Vector3 p) { return Vector3Length(p) > 18.0f; });
+        obstacles.insert(obstacles.end(), levelSampler.points.begin(), levelSampler.points.end());
+        obstacleGrid.Build(obstacles);
+
+        // Enemies take a shuffled subset of a second disk's points, so a
+        // small count is spread over the field rather than grown from one
+        // spot. Counts past what the field holds are clamped.
+        levelSampler.Reset({-75.0f, -75.0f}, {75.0f, 75.0f}, SPAWN_SPACING);
+        levelSampler.Fill(layout, [](Vector3 p) {
+            float dist = Vector3Length(p);
+            return dist >= 18.0f && dist <= 75.0f && !obstacleGrid.AnyWithin(p, SPAWN_PILLAR_CLEARANCE);
+        });
+        std::vector<Vector3>& spawns = levelSampler.points;
+        int enemyCount = std::min(hordeMode ? HORDE_ENEMY_COUNT : levelOneEnemyCount, (int)spawns.size());
+        for (int i = 0; i < enemyCount; i++) {
+            std::swap(spawns[i], spawns[layout.Range(i, (int)spawns.size() - 1)]);
+            Vector3 pos = spawns[i];
 
             Enemy e{};
+            EnemyMemory m{};
             e.position = pos;
-            e.homePosition = pos;
-            e.patrolTarget = pos;
-            e.patrolRadius = GetRandomValue(16, 32);
+            m.homePosition = pos;
+            m.patrolTarget = pos;
+            m.patrolRadius = layout.Range(16, 32);
             e.alive = true;
             e.swingYaw = 30.0f;
             e.swingPitch = -30.0f;
-            e.attackCooldown = (float)GetRandomValue(0, 100) / 100.0f;
-            e.strafeTimer = (float)GetRandomValue(30, 80) / 10.0f;
-            e.strafeSide = GetRandomValue(0, 1) == 0 ? -1.0f : 1.0f;
-
-            int typeRoll = GetRandomValue(0, 100);
-            if (typeRoll < 45) {
-                e.type = GRUNT;
-                e.scale = 0.95f;
-                e.health = 180; e.maxHealth = 180;
-                e.poise = 65; e.maxPoise = 65;
-                e.speed = ENEMY_BASE_SPEED * 1.05f;
-                e.bodyColor = {140, 40, 60, 255};
-                e.attackDamage = 31.0f;
-                e.poiseDamage = 36.0f;
-                e.attackDur = 0.43f;
-                e.dodgeChance = 0.52f;
-            }
-            else if (typeRoll < 80) {
-                e.type = TANK;
-                e.scale = 1.28f;
-                e.health = 340; e.maxHealth = 340;
-                e.poise = 160; e.maxPoise = 160;
-                e.speed = ENEMY_BASE_SPEED * 0.82f;
-                e.bodyColor = {60, 80, 160, 255};
-                e.patrolRadius *= 0.7f;
-                e.attackDamage = 46.0f;
-                e.poiseDamage = 60.0f;
-                e.attackDur = 0.60f;
-                e.dodgeChance = 0.25f;
-            }
-            else {
-                e.type = AGILE;
-                e.scale = 1.05f;
-                e.health = 160; e.maxHealth = 160;
-                e.poise = 55; e.maxPoise = 55;
-                e.speed = ENEMY_BASE_SPEED * 1.25f;
-                e.bodyColor = {100, 180, 80, 255};
-                e.attackDamage = 27.0f;
-                e.poiseDamage = 32.0f;
-                e.attackDur = 0.36f;
-                e.dodgeChance = 0.82f;
-            }
+            m.attackCooldown = (float)layout.Range(0, 100) / 100.0f;
+            m.strafeTimer = (float)layout.Range(30, 80) / 10.0f;
+            m.strafeSide = layout.Range(0, 1) == 0 ? -1.0f : 1.0f;
+
+            e.type = RollEnemyType(layout.Range(0, 100));
+            m.patrolRadius *= Archetype(e.type).patrolRadiusScale;
+            e.health = Archetype(e.type).health;
+            e.poise = Archetype(e.type).poise;
             enemies.push_back(e);
+            enemyMemory.push_back(m);
         }
 
-        // Exit portal position
-        do {
-            exitPosition.x = GetRandomValue(-border+25, border-25);
-            exitPosition.z = GetRandomValue(-border+25, border-25);
-        } while (Vector3Distance(exitPosition, {0,0,0}) < 55.0f);
-        exitPosition.y = 0;
+        // Exit portal somewhere in the corners of the +-55 square that are at
+        // least 55 from the start. Drawn in polar form so no draw is rejected.
+        float exitAngle = layout.Float(0.0f, 2.0f * PI);
+        float exitReach = 55.0f / std::max(fabsf(cosf(exitAngle)), fabsf(sinf(exitAngle)));
+        float exitDist = layout.Float(55.0f, exitReach);
+        exitPosition = {cosf(exitAngle) * exitDist, 0.0f, sinf(exitAngle) * exitDist};
     }
     else if (currentLevel == 2) {
         // Player starts farther back for dramatic entrance
@@ -457,33 +1975,105 @@ void ResetLevel() {
             Vector3 pos = {cosf(ang) * radius, 0, sinf(ang) * radius};
             obstacles.push_back(pos);
         }
+        obstacleGrid.Build(obstacles);
 
         // Boss
         Enemy boss{};
         boss.type = BOSS;
         boss.position = {0, 0, 40.0f};
-        boss.homePosition = boss.position;
-        boss.scale = 2.3f;
-        boss.health = 1600;
-        boss.maxHealth = 1600;
-        boss.poise = 320.0f;
-        boss.maxPoise = 320.0f;
-        boss.speed = ENEMY_BASE_SPEED * 0.88f;
-        boss.bodyColor = {180, 30, 50, 255};
-        boss.attackDamage = 48.0f;
-        boss.poiseDamage = 72.0f;
-        boss.attackDur = 0.55f;
-        boss.dodgeChance = 0.35f;
+        boss.health = Archetype(BOSS).health;
+        boss.poise = Archetype(BOSS).poise;
         enemies.push_back(boss);
+        EnemyMemory bossMemory{};
+        bossMemory.homePosition = boss.position;
+        enemyMemory.push_back(bossMemory);
     }
 
+    enemyPrevPose.assign(enemies.size(), EnemyPrevPose{});
+    for (auto& group : enemyGroups) group.clear();
+    for (size_t i = 0; i < enemies.size(); i++) enemyGroups[enemies[i].type].push_back((int)i);
+
+    BuildStaticGeometry();
     gameState = PLAYING;
+    simAccumulator = 0.0f;
+    trailSampleTimer = 0.0f;
+    weaponTrail.clear();
+    input = {};
+    SaveInterpolationState();
 }
 
 // ======================================================================
 // Core Update Loop
 // ======================================================================
+void PollInput() {
+    Vector2 delta = GetMouseDelta();
+    input.mouseDelta.x += delta.x;
+    input.mouseDelta.y += delta.y;
+    input.forward = IsKeyDown(KEY_W);
+    input.back = IsKeyDown(KEY_S);
+    input.left = IsKeyDown(KEY_A);
+    input.right = IsKeyDown(KEY_D);
+    input.sprintHeld = IsKeyDown(KEY_LEFT_SHIFT);
+    input.attackHeld = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+    input.attackReleased |= IsMouseButtonReleased(MOUSE_BUTTON_LEFT);
+    input.lockPressed |= IsKeyPressed(KEY_F);
+    input.rollPressed |= IsKeyPressed(KEY_LEFT_SHIFT);
+    input.jumpPressed |= IsKeyPressed(KEY_SPACE);
+    input.flaskPressed |= IsKeyPressed(KEY_E);
+    input.parryPressed |= IsKeyPressed(KEY_LEFT_CONTROL);
+}
+
+void ClearInputEdges() {
+    input.mouseDelta = {0,0};
+    input.attackReleased = false;
+    input.lockPressed = false;
+    input.rollPressed = false;
+    input.jumpPressed = false;
+    input.flaskPressed = false;
+    input.parryPressed = false;
+}
+
+void SaveInterpolationState() {
+    player.prevPosition = player.position;
+    player.prevRotation = player.rotation;
+    player.prevSwingYaw = player.swingYaw;
+    player.prevSwingPitch = player.swingPitch;
+    for (size_t i = 0; i < enemies.size(); i++) {
+        const Enemy& e = enemies[i];
+        enemyPrevPose[i] = {e.position, e.rotation, e.swingYaw, e.swingPitch};
+    }
+    prevCameraPosition = camera.position;
+    prevCameraTarget = camera.target;
+}
+
+// One SIM_DT tick, including the state transitions that used to run per frame.
+// Returns true when the tick moved to a new level (ResetLevel() ran).
+bool StepSimulation() {
+    PROFILE_ZONE("StepSimulation");
+    SaveInterpolationState();
+    UpdateGame(SIM_DT);
+
+    // Level transition (only for level 1 → level 2)
+    if (currentLevel == 1 && exitActive && Vector3Distance(player.position, exitPosition) < 9.0f) {
+        currentLevel = 2;
+        ResetLevel();
+        return true;
+    }
+
+    // Death check
+    if (player.health <= 0 && !player.isDead) {
+        player.isDead = true;
+        player.deathTimer = 3.2f;
+        player.deathFallAngle = 0.0f;
+        gameState = DEAD;
+        currentDeathMessage = deathMessages[fxRng.Range(0, (int)deathMessages.size()-1)].c_str();
+    }
+    return false;
+}
+
 void UpdateGame(float dt) {
+    simTick++;
+    particles.BeginTick();
     UpdateCamera(dt);
 
     float effectiveDt = dt;
@@ -497,18 +2087,18 @@ void UpdateGame(float dt) {
     UpdateEnemies(effectiveDt);
     UpdateParticles(effectiveDt);
 
-    // Floating ash particles
-    if (GetRandomValue(0, 30) == 0) {
-        float x = player.position.x + GetRandomValue(-80, 80);
-        float z = player.position.z + GetRandomValue(-80, 80);
-        Vector3 pos = {x, 35.0f + GetRandomValue(0, 20), z};
-        Particle p{};
-        p.position = pos;
-        p.velocity = {GetRandomValue(-8, 8)/10.0f, -2.2f, GetRandomValue(-8, 8)/10.0f};
-        p.lifetime = p.maxLife = 20.0f;
-        p.color = Fade(GRAY, 0.35f);
-        p.size = GetRandomValue(3, 8)/10.0f;
-        particles.push_back(p);
+    // Floating ash particles (~2/s at SIM_HZ on the HIGH tier)
+    if (fxRng.Float(0.0f, 61.0f) < Quality().particleScale) {
+        float x = player.position.x + fxRng.Range(-80, 80);
+        float z = player.position.z + fxRng.Range(-80, 80);
+        Vector3 pos = {x, 35.0f + fxRng.Range(0, 20), z};
+        if (Particle* p = particles.Spawn()) {
+            p->position = pos;
+            p->velocity = {fxRng.Range(-8, 8)/10.0f, -2.2f, fxRng.Range(-8, 8)/10.0f};
+            p->lifetime = p->maxLife = 20.0f;
+            p->color = Fade(GRAY, 0.35f);
+            p->size = fxRng.Range(3, 8)/10.0f;
+        }
     }
 
     // Victory conditions
@@ -526,6 +2116,7 @@ void UpdateGame(float dt) {
 // Player Update
 // ======================================================================
 void UpdatePlayer(float dt) {
+    PROFILE_ZONE("UpdatePlayer");
     player.perfectRollTimer = std::max(0.0f, player.perfectRollTimer - dt);
     player.riposteTimer = std::max(0.0f, player.riposteTimer - dt);
 
@@ -541,13 +2132,13 @@ void UpdatePlayer(float dt) {
     player.comboTimer -= dt;
 
     // Mouse look
-    Vector2 mouseDelta = GetMouseDelta();
+    Vector2 mouseDelta = input.mouseDelta;
     float sens = MOUSE_SENSITIVITY;
     if (player.isAttacking || player.isParrying || player.staggerTimer > 0) sens *= 0.4f;
     player.rotation -= mouseDelta.x * sens;
 
     // Target lock
-    if (IsKeyPressed(KEY_F)) {
+    if (input.lockPressed) {
         if (player.lockedTarget != -1) {
             player.lockedTarget = -1;
         } else {
@@ -615,10 +2206,10 @@ void UpdatePlayer(float dt) {
 
     // Movement input
     Vector3 moveInput{0,0,0};
-    if (IsKeyDown(KEY_W)) moveInput.z += 1;
-    if (IsKeyDown(KEY_S)) moveInput.z -= 1;
-    if (IsKeyDown(KEY_D)) moveInput.x -= 1;
-    if (IsKeyDown(KEY_A)) moveInput.x += 1;
+    if (input.forward) moveInput.z += 1;
+    if (input.back) moveInput.z -= 1;
+    if (input.right) moveInput.x -= 1;
+    if (input.left) moveInput.x += 1;
     bool hasMoveInput = Vector3Length(moveInput) > 0.01f;
     if (hasMoveInput) moveInput = Vector3Normalize(moveInput);
 
@@ -642,7 +2233,7 @@ void UpdatePlayer(float dt) {
 
     // Speed & sprint
     float speed = BASE_PLAYER_SPEED;
-    bool sprinting = IsKeyDown(KEY_LEFT_SHIFT) && hasMoveInput && player.stamina > 8.0f && !player.isRolling;
+    bool sprinting = input.sprintHeld && hasMoveInput && player.stamina > 8.0f && !player.isRolling;
     if (sprinting) {
         speed *= SPRINT_MULTIPLIER;
         player.stamina -= STAMINA_SPRINT_COST * dt;
@@ -654,7 +2245,7 @@ void UpdatePlayer(float dt) {
     }
 
     // Roll (Shift tap)
-    if (IsKeyPressed(KEY_LEFT_SHIFT) && hasMoveInput && player.stamina >= ROLL_COST &&
+    if (input.rollPressed && hasMoveInput && player.stamina >= ROLL_COST &&
         !player.isAttacking && !player.isRolling && !player.isParrying && !player.isHealing && player.staggerTimer <= 0) {
         player.isRolling = true;
         player.rollTimer = ROLL_DURATION;
@@ -677,7 +2268,7 @@ void UpdatePlayer(float dt) {
         if (perfectWindowActive && player.perfectRollTimer <= 0.0f) {
             for (auto& e : enemies) {
                 if (!e.alive || !e.isAttacking) continue;
-                float dur = e.attackDur * (e.isHeavyAttack ? 1.75f : 1.0f);
+                float dur = Archetype(e.type).attackDur * (e.isHeavyAttack ? 1.75f : 1.0f);
                 float prog = 1.0f - (e.attackTimer / dur);
                 float hitStart = e.isHeavyAttack ? 0.22f : 0.20f;
                 float hitEnd = e.isHeavyAttack ? 0.85f : 0.80f;
@@ -702,13 +2293,8 @@ void UpdatePlayer(float dt) {
         player.velocity = Vector3Lerp(player.velocity, desiredVel, 22.0f * dt);
 
         Vector3 newPos = Vector3Add(player.position, Vector3Scale(player.velocity, dt));
-        bool collision = false;
-        for (const auto& obs : obstacles) {
-            if (Vector3Distance({newPos.x, player.position.y, newPos.z}, obs) < 6.8f) {
-                collision = true;
-                break;
-            }
-        }
+        HEADLESS_SCOPE(HS_COLLISION);
+        bool collision = obstacleGrid.AnyWithin({newPos.x, player.position.y, newPos.z}, 6.8f);
         if (!collision) {
             player.position.x = newPos.x;
             player.position.z = newPos.z;
@@ -726,7 +2312,7 @@ void UpdatePlayer(float dt) {
     }
 
     bool grounded = (player.position.y <= 0.05f);
-    if (IsKeyPressed(KEY_SPACE) && grounded && player.stamina >= 5.0f &&
+    if (input.jumpPressed && grounded && player.stamina >= 5.0f &&
         !player.isAttacking && !player.isRolling && !player.isParrying && !player.isHealing &&
         player.staggerTimer <= 0) {
         player.yVelocity = JUMP_VELOCITY;
@@ -734,7 +2320,7 @@ void UpdatePlayer(float dt) {
     }
 
     // Flask
-    if (IsKeyPressed(KEY_E) && player.flasks > 0 && !player.isHealing &&
+    if (input.flaskPressed && player.flasks > 0 && !player.isHealing &&
         !player.isAttacking && !player.isRolling && !player.isParrying && player.staggerTimer <= 0) {
         player.isHealing = true;
         player.healTimer = FLASK_USE_TIME;
@@ -749,7 +2335,7 @@ void UpdatePlayer(float dt) {
     }
 
     // Parry
-    if (IsKeyPressed(KEY_LEFT_CONTROL) && player.stamina >= STAMINA_PARRY_COST &&
+    if (input.parryPressed && player.stamina >= STAMINA_PARRY_COST &&
         !player.isAttacking && !player.isRolling && !player.isHealing && player.staggerTimer <= 0) {
         player.isParrying = true;
         player.parryTimer = 0.38f;
@@ -762,8 +2348,8 @@ void UpdatePlayer(float dt) {
     }
 
     // Attack input
-    bool attackInput = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
-    bool attackRelease = IsMouseButtonReleased(MOUSE_BUTTON_LEFT);
+    bool attackInput = input.attackHeld;
+    bool attackRelease = input.attackReleased;
 
     if (attackInput && !player.isCharging && !player.isAttacking && !player.isRolling &&
         !player.isParrying && !player.isHealing && player.stamina >= STAMINA_POWER_COST &&
@@ -840,6 +2426,7 @@ void UpdatePlayer(float dt) {
 
         // Hit window
         if (progress > 0.18f && progress < 0.82f) {
+            HEADLESS_SCOPE(HS_COLLISION);
             for (auto& e : enemies) {
                 CheckPlayerAttackHitEnemy(e);
             }
@@ -856,7 +2443,7 @@ void UpdatePlayer(float dt) {
         if (player.comboTimer <= 0.0f) player.comboStep = 0;
     }
 
-    AddWeaponTrailPoint();
+    AddWeaponTrailPoint(dt);
 
     // Blade position
     float yawRad = player.swingYaw * DEG2RAD;
@@ -883,184 +2470,316 @@ void UpdatePlayer(float dt) {
 // ======================================================================
 // Enemy Update
 // ======================================================================
-void UpdateEnemies(float dt) {
-    for (auto& e : enemies) {
-        if (!e.alive) continue;
+// Attack slots cap how many enemies press the player at once: each tick the
+// chasers inside ATTACK_SLOT_ENGAGE are ranked (current attackers first, then
+// by distance, then index) and the first ATTACK_SLOTS take the free slot
+// nearest their bearing. Slotted enemies approach their slot's side of the
+// player and may attack; the rest circle at CROWD_WAIT_RADIUS. After
+// movement, ResolveCrowd() buckets everyone into crowdGrid and pushes
+// overlapping bodies apart (both sides at once, so the result does not
+// depend on update order), keeps them off the player, and slides them out
+// of pillars. All of it is a function of sim state only, so seeded runs
+// still replay exactly.
+Vector3 AttackSlotPoint(int slot) {
+    float angle = 2.0f * PI * slot / ATTACK_SLOTS;
+    return Vector3Add(player.position, {cosf(angle) * ATTACK_RANGE, 0.0f, sinf(angle) * ATTACK_RANGE});
+}
 
-        e.hitInvuln -= dt;
-        e.stunTimer -= dt;
-        e.staminaRegenDelay -= dt;
-        if (e.staminaRegenDelay <= 0) {
-            e.stamina = std::min(e.stamina + 32.0f * dt, (float)MAX_STAMINA);
+void AssignAttackSlots() {
+    slotCandidates.clear();
+    for (size_t i = 0; i < enemies.size(); i++) {
+        Enemy& e = enemies[i];
+        e.attackSlot = -1;
+        if (!e.alive || e.type == BOSS || e.state == PATROL) continue;
+        float dist = Vector3Distance({e.position.x, 0, e.position.z}, {player.position.x, 0, player.position.z});
+        if (dist > ATTACK_SLOT_ENGAGE) continue;
+        slotCandidates.push_back({e.isAttacking ? -1.0f : dist, (int)i});
+    }
+    std::sort(slotCandidates.begin(), slotCandidates.end());
+
+    bool taken[ATTACK_SLOTS] = {};
+    attackSlotsTaken = std::min((int)slotCandidates.size(), ATTACK_SLOTS);
+    for (int c = 0; c < attackSlotsTaken; c++) {
+        Enemy& e = enemies[slotCandidates[c].second];
+        float bearing = atan2f(e.position.z - player.position.z, e.position.x - player.position.x);
+        int best = -1;
+        float bestCos = -2.0f;
+        for (int slot = 0; slot < ATTACK_SLOTS; slot++) {
+            float cosine = cosf(bearing - 2.0f * PI * slot / ATTACK_SLOTS);
+            if (!taken[slot] && cosine > bestCos) { best = slot; bestCos = cosine; }
         }
+        taken[best] = true;
+        e.attackSlot = best;
+    }
+}
 
-        if (e.stunTimer > 0) {
-            e.velocity = Vector3Lerp(e.velocity, {0,0,0}, 12.0f * dt);
-            continue;
-        }
+void ResolveCrowd() {
+    HEADLESS_SCOPE(HS_COLLISION);
+    crowdGrid.Build(enemies);
+    crowdPush.assign(enemies.size(), {0, 0, 0});
+    for (size_t i = 0; i < enemies.size(); i++) {
+        const Enemy& e = enemies[i];
+        if (!e.alive) continue;
+        float radius = CrowdRadius(e);
+        Vector3& push = crowdPush[i];
+        auto separate = [&](Vector3 other, float minDist, float share) {
+            float dx = e.position.x - other.x, dz = e.position.z - other.z;
+            float distSq = dx*dx + dz*dz;
+            if (distSq >= minDist * minDist) return;
+            float dist = sqrtf(distSq);
+            Vector3 away = {1.0f, 0.0f, 0.0f};
+            if (dist > 1e-4f) {
+                away = {dx / dist, 0.0f, dz / dist};
+            } else {
+                float angle = (float)i * 2.39996f;  // Coincident: spread by index
+                away = {cosf(angle), 0.0f, sinf(angle)};
+            }
+            push = Vector3Add(push, Vector3Scale(away, (minDist - dist) * share * CROWD_STIFFNESS));
+        };
+        crowdGrid.ForEachNear(e.position, radius + crowdGrid.maxRadius, [&](int j) {
+            if (j != (int)i) separate(enemies[j].position, radius + CrowdRadius(enemies[j]), 0.5f);
+        });
+        if (!player.isDead) separate(player.position, radius + PLAYER_CROWD_RADIUS, 1.0f);
+    }
+    for (size_t i = 0; i < enemies.size(); i++) {
+        Enemy& e = enemies[i];
+        if (!e.alive) continue;
+        e.position = obstacleGrid.PushOut(Vector3Add(e.position, crowdPush[i]), CrowdRadius(e));
+    }
+}
 
-        bool seesPlayer = CanSeePlayer(e);
-        Vector3 toPlayer = Vector3Subtract(player.position, e.position);
-        toPlayer.y = 0.0f;
-        float distToPlayer = Vector3Length(toPlayer);
+// AI level of detail. Perception and decisions are the expensive part of an
+// enemy (CanSeePlayer walks the obstacle grid), so only engaged enemies run
+// them every tick; the rest think on a stride, staggered by index so each
+// tick carries an even share. Kinematics, dodge/block reactions and attack
+// execution still run every tick for everyone. The schedule depends only on
+// simTick and the enemy index, so seeded runs stay reproducible.
+const int AI_THINK_INTERVAL[AI_LOD_COUNT] = {1, 4, 12};  // Sim ticks between thinks
+
+template <EnemyType T>
+AiLod ClassifyEnemyLod(const Enemy& e, float distToPlayer) {
+    if constexpr (T == BOSS) return AI_LOD_FULL;
+    if (e.isAttacking || e.isDodging || e.isBlocking || e.hitInvuln > 0.0f)
+        return AI_LOD_FULL;
+    if (e.state != PATROL) return distToPlayer < 45.0f ? AI_LOD_FULL : AI_LOD_MID;
+    return distToPlayer < AI_LOD_FAR_RANGE ? AI_LOD_MID : AI_LOD_FAR;
+}
 
-        Vector3 moveDir{0,0,0};
-        float moveSpeed = e.speed * (e.stamina <= 0.0f ? EXHAUSTED_MULTIPLIER : 1.0f);
+// Perception and decisions for one enemy: awareness, facing, strafing, patrol
+// targets and attack choice. Writes the desired heading to e.moveDir and
+// e.moveScale for the per-tick kinematics in UpdateEnemy(). dt is the time
+// since this enemy last thought, which is several ticks at the coarser LODs.
+template <EnemyType T>
+void ThinkEnemy(Enemy& e, EnemyMemory& m, Rng& ai, float dt, Vector3 toPlayer, float distToPlayer) {
+    constexpr const EnemyArchetype& A = Archetype(T);
+    bool seesPlayer = CanSeePlayer(e);
+    Vector3 moveDir{0,0,0};
+    e.moveScale = 1.0f;
 
-        if (e.type == BOSS) {
+    if constexpr (T == BOSS) {
+        e.state = CHASE;
+        m.alertTimer = 10.0f;
+        if (distToPlayer > 0.5f) {
+            e.rotation = atan2f(toPlayer.x, toPlayer.z) * RAD2DEG;
+        }
+        Vector3 forward = Vector3Normalize(toPlayer);
+        Vector3 tangent = {forward.z, 0.0f, -forward.x};
+        tangent = Vector3Scale(tangent, m.strafeSide * 0.3f);
+        moveDir = Vector3Add(forward, tangent);
+        moveDir = Vector3Normalize(moveDir);
+        e.moveScale = A.chaseSpeedScale;
+
+        m.comboDelayTimer -= dt;
+        Vector3 eFacing = {sinf(e.rotation*DEG2RAD), 0, cosf(e.rotation*DEG2RAD)};
+        float dot = Vector3DotProduct(eFacing, Vector3Normalize(toPlayer));
+        if (distToPlayer <= ATTACK_RANGE + 5.0f && dot > 0.5f && !e.isAttacking && m.comboDelayTimer <= 0.0f && e.stamina >= 30.0f) {
+            e.comboStep = (e.comboStep % 5) + 1;
+            if (e.comboStep == 1) m.comboDelayTimer = 2.2f;
+            e.isAttacking = true;
+            float dur = (e.comboStep == 3 || e.comboStep == 5) ? 0.85f : 0.55f;
+            e.attackTimer = dur;
+            e.stamina -= 30.0f;
+            e.staminaRegenDelay = 1.2f;
+        }
+    } else {
+        // Awareness
+        if (seesPlayer) {
+            m.lastKnownPlayerPos = player.position;
+            m.alertTimer = 12.0f;
             e.state = CHASE;
-            e.alertTimer = 10.0f;
-            if (distToPlayer > 0.5f) {
-                e.rotation = atan2f(toPlayer.x, toPlayer.z) * RAD2DEG;
-            }
-            Vector3 forward = Vector3Normalize(toPlayer);
-            Vector3 tangent = {forward.z, 0.0f, -forward.x};
-            tangent = Vector3Scale(tangent, e.strafeSide * 0.3f);
-            moveDir = Vector3Add(forward, tangent);
-            moveDir = Vector3Normalize(moveDir);
-            moveSpeed *= 1.1f;
-
-            e.comboDelayTimer -= dt;
-            Vector3 eFacing = {sinf(e.rotation*DEG2RAD), 0, cosf(e.rotation*DEG2RAD)};
-            float dot = Vector3DotProduct(eFacing, Vector3Normalize(toPlayer));
-            if (distToPlayer <= ATTACK_RANGE + 5.0f && dot > 0.5f && !e.isAttacking && e.comboDelayTimer <= 0.0f && e.stamina >= 30.0f) {
-                e.comboStep = (e.comboStep % 5) + 1;
-                if (e.comboStep == 1) e.comboDelayTimer = 2.2f;
-                e.isAttacking = true;
-                float dur = (e.comboStep == 3 || e.comboStep == 5) ? 0.85f : 0.55f;
-                e.attackTimer = dur;
-                e.stamina -= 30.0f;
-                e.staminaRegenDelay = 1.2f;
+        } else if (m.alertTimer > 0.0f) {
+            m.alertTimer -= dt;
+            if (Vector3Distance(e.position, m.lastKnownPlayerPos) < 8.0f) {
+                e.state = SEARCH;
             }
         } else {
-            // Awareness
-            if (seesPlayer) {
-                e.lastKnownPlayerPos = player.position;
-                e.alertTimer = 12.0f;
-                e.state = CHASE;
-            } else if (e.alertTimer > 0.0f) {
-                e.alertTimer -= dt;
-                if (Vector3Distance(e.position, e.lastKnownPlayerPos) < 8.0f) {
-                    e.state = SEARCH;
-                }
-            } else {
-                e.state = PATROL;
-            }
+            e.state = PATROL;
+        }
 
-            e.attackCooldown -= dt;
+        m.attackCooldown -= dt;
 
-            bool inCombatRange = (e.state != PATROL) && distToPlayer < 45.0f;
-            if (inCombatRange) {
-                e.strafeTimer -= dt;
-                if (e.strafeTimer <= 0.0f) {
-                    e.strafeSide *= -1.0f;
-                    e.strafeTimer = (float)GetRandomValue(30, 70) / 10.0f;
-                }
+        bool inCombatRange = (e.state != PATROL) && distToPlayer < 45.0f;
+        if (inCombatRange) {
+            m.strafeTimer -= dt;
+            if (m.strafeTimer <= 0.0f) {
+                m.strafeSide *= -1.0f;
+                m.strafeTimer = (float)ai.Range(30, 70) / 10.0f;
             }
+        }
 
-            // Patrol behavior
-            if (e.state == PATROL) {
-                e.patrolTimer -= dt;
-                if (e.patrolTimer <= 0.0f || Vector3Distance(e.position, e.patrolTarget) < 6.0f) {
-                    float ang = (float)GetRandomValue(0, 359) * DEG2RAD;
-                    float r = (float)GetRandomValue(0, (int)e.patrolRadius);
-                    e.patrolTarget = Vector3Add(e.homePosition, {cosf(ang)*r, 0.0f, sinf(ang)*r});
-                    e.patrolTimer = (float)GetRandomValue(6, 14);
-                }
-                Vector3 toPatrol = Vector3Subtract(e.patrolTarget, e.position);
-                toPatrol.y = 0.0f;
-                if (Vector3Length(toPatrol) > 1.0f) {
-                    moveDir = Vector3Normalize(toPatrol);
-                    moveSpeed *= 0.55f;
-                }
-                e.rotation = atan2f(toPatrol.x, toPatrol.z) * RAD2DEG;
+        // Patrol behavior
+        if (e.state == PATROL) {
+            m.patrolTimer -= dt;
+            if (m.patrolTimer <= 0.0f || Vector3Distance(e.position, m.patrolTarget) < 6.0f) {
+                float ang = (float)ai.Range(0, 359) * DEG2RAD;
+                float r = (float)ai.Range(0, (int)m.patrolRadius);
+                m.patrolTarget = Vector3Add(m.homePosition, {cosf(ang)*r, 0.0f, sinf(ang)*r});
+                m.patrolTimer = (float)ai.Range(6, 14);
+            }
+            Vector3 toPatrol = Vector3Subtract(m.patrolTarget, e.position);
+            toPatrol.y = 0.0f;
+            if (Vector3Length(toPatrol) > 1.0f) {
+                moveDir = Vector3Normalize(toPatrol);
+                e.moveScale = 0.55f;
+            }
+            e.rotation = atan2f(toPatrol.x, toPatrol.z) * RAD2DEG;
+        } else {
+            if (seesPlayer) {
+                e.rotation = atan2f(toPlayer.x, toPlayer.z) * RAD2DEG;
+            }
+
+            if (distToPlayer > 45.0f) {
+                moveDir = Vector3Normalize(toPlayer);
             } else {
-                if (seesPlayer) {
-                    e.rotation = atan2f(toPlayer.x, toPlayer.z) * RAD2DEG;
+                Vector3 forward = Vector3Normalize(toPlayer);
+                Vector3 tangent = {forward.z, 0.0f, -forward.x};
+                // Close in on the slot's side of the player rather than head-on
+                Vector3 approach = forward;
+                if (e.attackSlot >= 0 && distToPlayer > ATTACK_RANGE + 3.0f) {
+                    Vector3 toSlot = Vector3Subtract(AttackSlotPoint(e.attackSlot), e.position);
+                    toSlot.y = 0.0f;
+                    if (Vector3Length(toSlot) > 0.5f) approach = Vector3Normalize(toSlot);
                 }
-
-                if (distToPlayer > 45.0f) {
-                    moveDir = Vector3Normalize(toPlayer);
-                } else {
-                    Vector3 forward = Vector3Normalize(toPlayer);
-                    Vector3 tangent = {forward.z, 0.0f, -forward.x};
-                    tangent = Vector3Scale(tangent, e.strafeSide);
-                    float forwardAmt = (distToPlayer > ATTACK_RANGE + 3.0f) ? 0.6f : 0.3f;
-                    float strafeAmt = 0.7f;
-                    if (e.type == TANK) {
-                        forwardAmt = (distToPlayer > ATTACK_RANGE + 3.0f) ? 0.8f : 0.6f;
-                        strafeAmt = 0.3f;
-                    } else if (e.type == AGILE) {
-                        forwardAmt = (distToPlayer > ATTACK_RANGE + 3.0f) ? 0.4f : 0.1f;
-                        strafeAmt = 0.9f;
-                        moveSpeed *= 1.15f;
-                    }
-                    moveDir = Vector3Add(Vector3Scale(forward, forwardAmt), Vector3Scale(tangent, strafeAmt));
-                    if (Vector3Length(moveDir) > 0.01f) moveDir = Vector3Normalize(moveDir);
-                    moveSpeed *= 0.85f;
+                tangent = Vector3Scale(tangent, m.strafeSide);
+                float forwardAmt = (distToPlayer > ATTACK_RANGE + 3.0f) ? A.chaseForwardFar : A.chaseForwardNear;
+                float strafeAmt = A.chaseStrafe;
+                e.moveScale = A.chaseSpeedScale;
+                // Without a slot, circle at the wait radius until one frees up
+                if (e.attackSlot < 0 && distToPlayer < ATTACK_SLOT_ENGAGE) {
+                    if (distToPlayer < CROWD_WAIT_RADIUS - 1.0f) forwardAmt = -0.5f;
+                    else if (distToPlayer > CROWD_WAIT_RADIUS + 1.0f) forwardAmt = 0.5f;
+                    else forwardAmt = 0.0f;
                 }
-            }
-
-            // Attack decision
-            Vector3 eFacing = {sinf(e.rotation * DEG2RAD), 0.0f, cosf(e.rotation * DEG2RAD)};
-            float dot = Vector3DotProduct(eFacing, Vector3Normalize(toPlayer));
-            if (distToPlayer <= ATTACK_RANGE + 1.8f && dot > 0.55f && e.attackCooldown <= 0.0f &&
-                e.stamina >= 26.0f && !e.isAttacking && !e.isDodging && !e.isBlocking && e.stunTimer <= 0.0f) {
-                bool wantHeavy = (e.type == TANK && GetRandomValue(0, 100) < 40);
-                bool canHeavy = (e.stamina >= 48.0f);
-                e.isHeavyAttack = wantHeavy && canHeavy;
-                float staminaCost = e.isHeavyAttack ? 48.0f : 26.0f;
-                float durMult = e.isHeavyAttack ? 1.75f : 1.0f;
-                e.attackTimer = e.attackDur * durMult;
-                e.currentAttack = e.isHeavyAttack ? LIGHT_1 : static_cast<AttackType>(GetRandomValue(0, 2));
-                e.isAttacking = true;
-                e.stamina -= staminaCost;
-                e.staminaRegenDelay = e.isHeavyAttack ? 1.4f : 0.8f;
-                float baseCd = (e.type == AGILE) ? 0.9f : ((e.type == TANK) ? 2.5f : 1.6f);
-                baseCd += e.isHeavyAttack ? 1.3f : 0.0f;
-                e.attackCooldown = baseCd + (float)GetRandomValue(0, 15) / 10.0f;
+                moveDir = Vector3Add(Vector3Scale(approach, forwardAmt), Vector3Scale(tangent, strafeAmt));
+                if (Vector3Length(moveDir) > 0.01f) moveDir = Vector3Normalize(moveDir);
+                e.moveScale *= 0.85f;
             }
         }
 
-        // Commit to attack (no movement)
-        if (e.isAttacking) {
-            moveDir = {0,0,0};
+        // Attack decision
+        Vector3 eFacing = {sinf(e.rotation * DEG2RAD), 0.0f, cosf(e.rotation * DEG2RAD)};
+        float dot = Vector3DotProduct(eFacing, Vector3Normalize(toPlayer));
+        if (distToPlayer <= ATTACK_RANGE + 1.8f && dot > 0.55f && m.attackCooldown <= 0.0f && e.attackSlot >= 0 &&
+            e.stamina >= 26.0f && !e.isAttacking && !e.isDodging && !e.isBlocking && e.stunTimer <= 0.0f) {
+            bool wantHeavy = false;
+            if constexpr (A.heavyPercent > 0) wantHeavy = ai.Range(0, 100) < A.heavyPercent;
+            bool canHeavy = (e.stamina >= 48.0f);
+            e.isHeavyAttack = wantHeavy && canHeavy;
+            float staminaCost = e.isHeavyAttack ? 48.0f : 26.0f;
+            float durMult = e.isHeavyAttack ? 1.75f : 1.0f;
+            e.attackTimer = A.attackDur * durMult;
+            e.currentAttack = e.isHeavyAttack ? LIGHT_1 : static_cast<AttackType>(ai.Range(0, 2));
+            e.isAttacking = true;
+            e.stamina -= staminaCost;
+            e.staminaRegenDelay = e.isHeavyAttack ? 1.4f : 0.8f;
+            float baseCd = A.attackCooldown;
+            baseCd += e.isHeavyAttack ? 1.3f : 0.0f;
+            m.attackCooldown = baseCd + (float)ai.Range(0, 15) / 10.0f;
         }
+    }
+
+    e.moveDir = moveDir;
+}
+
+// One enemy's tick: timers, thinking on its LOD stride, kinematics,
+// reactive dodge/block and attack execution
+template <EnemyType T>
+void UpdateEnemy(Enemy& e, int index, float dt) {
+    constexpr const EnemyArchetype& A = Archetype(T);
+    Rng ai = Rng::Stream(RNG_ENEMY_AI, index, simTick);
+
+    e.hitInvuln -= dt;
+    e.stunTimer -= dt;
+    e.staminaRegenDelay -= dt;
+    if (e.staminaRegenDelay <= 0) {
+        e.stamina = std::min(e.stamina + 32.0f * dt, (float)MAX_STAMINA);
+    }
+
+    if (e.stunTimer > 0) {
+        e.velocity = Vector3Lerp(e.velocity, {0,0,0}, 12.0f * dt);
+        return;
+    }
+
+    Vector3 toPlayer = Vector3Subtract(player.position, e.position);
+    toPlayer.y = 0.0f;
+    float distToPlayer = Vector3Length(toPlayer);
+
+    AiLod lod = ClassifyEnemyLod<T>(e, distToPlayer);
+    aiLodCounts[lod]++;
+    HEADLESS_COUNT(enemyUpdates);
+    e.thinkAccum += dt;
+    if ((simTick + index) % AI_THINK_INTERVAL[lod] == 0) {
+        HEADLESS_COUNT(enemyThinks);
+        ThinkEnemy<T>(e, enemyMemory[index], ai, e.thinkAccum, toPlayer, distToPlayer);
+        e.thinkAccum = 0.0f;
+    }
 
-        e.velocity = Vector3Lerp(e.velocity, Vector3Scale(moveDir, moveSpeed), 12.0f * dt);
-        e.position = Vector3Add(e.position, Vector3Scale(e.velocity, dt));
+    Vector3 moveDir = e.moveDir;
+    float moveSpeed = ENEMY_BASE_SPEED * A.speed * e.moveScale * (e.stamina <= 0.0f ? EXHAUSTED_MULTIPLIER : 1.0f);
+
+    // Commit to attack (no movement)
+    if (e.isAttacking) {
+        moveDir = {0,0,0};
+    }
 
-        // Dodge player attack
-        if (player.isAttacking && distToPlayer < 9.0f && e.stamina >= 32.0f &&
-            !e.isDodging && !e.isAttacking && !e.isBlocking &&
-            GetRandomValue(0, 100) < (int)(e.dodgeChance * 100.0f)) {
-            e.isDodging = true;
-            e.dodgeTimer = ROLL_DURATION;
-            e.dodgeStartPos = e.position;
-            Vector3 dodgeDir = Vector3Normalize(Vector3Subtract(e.position, player.position));
-            if (e.type == AGILE && GetRandomValue(0, 100) < 60) {
+    e.velocity = Vector3Lerp(e.velocity, Vector3Scale(moveDir, moveSpeed), 12.0f * dt);
+    if (!e.isDodging) e.position = Vector3Add(e.position, Vector3Scale(e.velocity, dt));
+
+    // Dodge player attack
+    if (player.isAttacking && distToPlayer < 9.0f && e.stamina >= 32.0f &&
+        !e.isDodging && !e.isAttacking && !e.isBlocking &&
+        ai.Range(0, 100) < (int)(A.dodgeChance * 100.0f)) {
+        e.isDodging = true;
+        e.dodgeTimer = ROLL_DURATION;
+        Vector3 dodgeDir = Vector3Normalize(Vector3Subtract(e.position, player.position));
+        if constexpr (A.sideStepPercent > 0) {
+            if (ai.Range(0, 100) < A.sideStepPercent) {
                 Vector3 side = {dodgeDir.z, 0.0f, -dodgeDir.x};
-                side = Vector3Scale(side, GetRandomValue(0, 1) ? 1.0f : -1.0f);
+                side = Vector3Scale(side, ai.Range(0, 1) ? 1.0f : -1.0f);
                 dodgeDir = Vector3Normalize(Vector3Add(dodgeDir, side));
             }
-            e.dodgeDirection = dodgeDir;
-            e.stamina -= 32.0f;
-            e.staminaRegenDelay = REGEN_DELAY_AFTER_ACTION;
         }
+        e.dodgeDirection = dodgeDir;
+        e.stamina -= 32.0f;
+        e.staminaRegenDelay = REGEN_DELAY_AFTER_ACTION;
+    }
 
-        if (e.isDodging) {
-            e.dodgeTimer -= dt;
-            float progress = 1.0f - (e.dodgeTimer / ROLL_DURATION);
-            float eased = progress * progress;
-            e.position = Vector3Add(e.dodgeStartPos,
-                                   Vector3Scale(e.dodgeDirection, 12.5f * eased));
-            if (e.dodgeTimer <= 0.0f) e.isDodging = false;
-        }
+    if (e.isDodging) {
+        // Advance by this tick's share of the eased curve, so crowd
+        // pushes and pillar slides from earlier ticks are kept
+        float before = 1.0f - (e.dodgeTimer / ROLL_DURATION);
+        e.dodgeTimer -= dt;
+        float progress = 1.0f - (e.dodgeTimer / ROLL_DURATION);
+        float eased = progress * progress - before * before;
+        e.position = Vector3Add(e.position, Vector3Scale(e.dodgeDirection, 12.5f * eased));
+        if (e.dodgeTimer <= 0.0f) e.isDodging = false;
+    }
 
-        // Tank block
-        if (e.type == TANK && !e.isBlocking && !e.isAttacking && !e.isDodging &&
+    // Shield block
+    if constexpr (A.blockPercent > 0) {
+        if (!e.isBlocking && !e.isAttacking && !e.isDodging &&
             player.isAttacking && distToPlayer < ATTACK_RANGE + 3.0f && e.stamina >= 22.0f &&
-            GetRandomValue(0, 100) < 75) {
+            ai.Range(0, 100) < A.blockPercent) {
             e.isBlocking = true;
             e.blockTimer = 0.7f;
             e.stamina -= 22.0f;
@@ -1070,95 +2789,107 @@ void UpdateEnemies(float dt) {
             e.blockTimer -= dt;
             if (e.blockTimer <= 0.0f) e.isBlocking = false;
         }
+    }
 
-        // Attack execution
-        if (e.isAttacking) {
-            float dur = (e.type == BOSS) ? ((e.comboStep == 3 || e.comboStep == 5) ? 0.85f : 0.55f)
-                                        : e.attackDur * (e.isHeavyAttack ? 1.75f : 1.0f);
-            float progress = 1.0f - (e.attackTimer / dur);
-
-            // Boss combo animations
-            if (e.type == BOSS) {
-                switch(e.comboStep) {
-                    case 1: e.swingYaw = Lerp(80.0f, -80.0f, progress);
-                            e.swingPitch = Lerp(90.0f, -70.0f, progress); break;
-                    case 2: e.swingYaw = Lerp(-120.0f, 120.0f, progress);
-                            e.swingPitch = Lerp(40.0f, -40.0f, progress); break;
-                    case 3: e.swingYaw = Lerp(-180.0f, 180.0f, progress);
-                            e.swingPitch = Lerp(0.0f, 0.0f, progress); break;
-                    case 4: e.swingYaw = Lerp(60.0f, -60.0f, progress);
-                            e.swingPitch = Lerp(-100.0f, 100.0f, progress); break;
-                    case 5: {
-                        float pp = progress * 3.0f;
-                        if (pp < 1.0f) {
-                            e.swingYaw = Lerp(100.0f, -100.0f, pp);
-                            e.swingPitch = Lerp(160.0f, -110.0f, pp);
-                        } else if (pp < 2.0f) {
-                            e.swingYaw = Lerp(-100.0f, 200.0f, pp - 1.0f);
-                            e.swingPitch = -110.0f;
-                        } else {
-                            e.swingYaw = Lerp(200.0f, 0.0f, pp - 2.0f);
-                            e.swingPitch = Lerp(-110.0f, 140.0f, pp - 2.0f);
-                        }
-                    } break;
-                }
+    // Attack execution
+    if (e.isAttacking) {
+        float dur = A.attackDur * (e.isHeavyAttack ? 1.75f : 1.0f);
+        if constexpr (T == BOSS) dur = (e.comboStep == 3 || e.comboStep == 5) ? 0.85f : 0.55f;
+        float progress = 1.0f - (e.attackTimer / dur);
+
+        // Boss combo animations
+        if constexpr (T == BOSS) {
+            switch(e.comboStep) {
+                case 1: e.swingYaw = Lerp(80.0f, -80.0f, progress);
+                        e.swingPitch = Lerp(90.0f, -70.0f, progress); break;
+                case 2: e.swingYaw = Lerp(-120.0f, 120.0f, progress);
+                        e.swingPitch = Lerp(40.0f, -40.0f, progress); break;
+                case 3: e.swingYaw = Lerp(-180.0f, 180.0f, progress);
+                        e.swingPitch = Lerp(0.0f, 0.0f, progress); break;
+                case 4: e.swingYaw = Lerp(60.0f, -60.0f, progress);
+                        e.swingPitch = Lerp(-100.0f, 100.0f, progress); break;
+                case 5: {
+                    float pp = progress * 3.0f;
+                    if (pp < 1.0f) {
+                        e.swingYaw = Lerp(100.0f, -100.0f, pp);
+                        e.swingPitch = Lerp(160.0f, -110.0f, pp);
+                    } else if (pp < 2.0f) {
+                        e.swingYaw = Lerp(-100.0f, 200.0f, pp - 1.0f);
+                        e.swingPitch = -110.0f;
+                    } else {
+                        e.swingYaw = Lerp(200.0f, 0.0f, pp - 2.0f);
+                        e.swingPitch = Lerp(-110.0f, 140.0f, pp - 2.0f);
+                    }
+                } break;
+            }
+        } else {
+            if (e.currentAttack == LIGHT_1) {
+                e.swingPitch = Lerp(110.0f, -95.0f, progress);
+                e.swingYaw = Lerp(80.0f, -80.0f, progress);
+            } else if (e.currentAttack == LIGHT_2) {
+                e.swingPitch = Lerp(30.0f, -30.0f, progress);
+                e.swingYaw = Lerp(-170.0f, 170.0f, progress);
             } else {
-                if (e.currentAttack == LIGHT_1) {
-                    e.swingPitch = Lerp(110.0f, -95.0f, progress);
-                    e.swingYaw = Lerp(80.0f, -80.0f, progress);
-                } else if (e.currentAttack == LIGHT_2) {
-                    e.swingPitch = Lerp(30.0f, -30.0f, progress);
-                    e.swingYaw = Lerp(-170.0f, 170.0f, progress);
-                } else {
-                    e.swingPitch = Lerp(-90.0f, 125.0f, progress);
-                    e.swingYaw = Lerp(-70.0f, 90.0f, progress);
-                }
+                e.swingPitch = Lerp(-90.0f, 125.0f, progress);
+                e.swingYaw = Lerp(-70.0f, 90.0f, progress);
             }
+        }
 
-            // Hit window
-            float hitStart = (e.type == BOSS && (e.comboStep == 3 || e.comboStep == 5)) ? 0.25f : 0.20f;
-            float hitEnd = (e.type == BOSS && e.comboStep == 3) ? 0.85f : 0.80f;
-            if (progress > hitStart && progress < hitEnd) {
-                if (IsEnemyAttackSwingHittingPlayer(e)) {
-                    if (player.isParrying && player.parryTimer > 0.12f) {
-                        player.riposteTimer = 1.8f;
-                        e.stunTimer = 2.8f;
-                        Vector3 knockDir = Vector3Normalize(Vector3Subtract(e.position, player.position));
-                        e.velocity = Vector3Add(e.velocity, Vector3Scale(knockDir, 28.0f));
-                        SpawnHitSparks(e.position, 24);
-                        hitStopTimer = std::max(hitStopTimer, 0.06f);
-                        player.shakeTimer = std::max(player.shakeTimer, 0.32f);
-                    } else if (!player.isRolling && player.hitInvuln <= 0.0f) {
-                        ApplyEnemyHitToPlayer(e);
-                    }
+        // Hit window
+        float hitStart = 0.20f;
+        float hitEnd = 0.80f;
+        if constexpr (T == BOSS) {
+            if (e.comboStep == 3 || e.comboStep == 5) hitStart = 0.25f;
+            if (e.comboStep == 3) hitEnd = 0.85f;
+        }
+        if (progress > hitStart && progress < hitEnd) {
+            if (IsEnemyAttackSwingHittingPlayer(e)) {
+                if (player.isParrying && player.parryTimer > 0.12f) {
+                    player.riposteTimer = 1.8f;
+                    e.stunTimer = 2.8f;
+                    Vector3 knockDir = Vector3Normalize(Vector3Subtract(e.position, player.position));
+                    e.velocity = Vector3Add(e.velocity, Vector3Scale(knockDir, 28.0f));
+                    SpawnHitSparks(e.position, 24);
+                    hitStopTimer = std::max(hitStopTimer, 0.06f);
+                    player.shakeTimer = std::max(player.shakeTimer, 0.32f);
+                } else if (!player.isRolling && player.hitInvuln <= 0.0f) {
+                    ApplyEnemyHitToPlayer(e);
                 }
             }
+        }
 
-            e.attackTimer -= dt;
-            if (e.attackTimer <= 0.0f) {
-                e.isAttacking = false;
-                e.isHeavyAttack = false;
-            }
-        } else if (!e.isBlocking && e.stunTimer <= 0.0f) {
-            e.swingPitch = Lerp(e.swingPitch, -30.0f, 14.0f * dt);
-            e.swingYaw = Lerp(e.swingYaw, 30.0f, 14.0f * dt);
+        e.attackTimer -= dt;
+        if (e.attackTimer <= 0.0f) {
+            e.isAttacking = false;
+            e.isHeavyAttack = false;
         }
+    } else if (!e.isBlocking && e.stunTimer <= 0.0f) {
+        e.swingPitch = Lerp(e.swingPitch, -30.0f, 14.0f * dt);
+        e.swingYaw = Lerp(e.swingYaw, 30.0f, 14.0f * dt);
+    }
+
+}
 
-        // Blade position
-        float bladeLen = (e.type == BOSS) ? 9.5f : 5.8f;
-        float er = e.rotation * DEG2RAD;
-        Vector3 epivot = Vector3Add(e.position, Vector3RotateByAxisAngle({0.65f,1.65f,0.4f}, {0,1,0}, er));
-        Vector3 ebaseLocal = {0,-0.7f,0.6f};
-        Vector3 etipLocal = {0,-0.7f, bladeLen};
-        Vector3 ebase = Vector3RotateByAxisAngle(ebaseLocal, {1,0,0}, e.swingPitch*DEG2RAD);
-        ebase = Vector3RotateByAxisAngle(ebase, {0,1,0}, e.swingYaw*DEG2RAD);
-        Vector3 etip = Vector3RotateByAxisAngle(etipLocal, {1,0,0}, e.swingPitch*DEG2RAD);
-        etip = Vector3RotateByAxisAngle(etip, {0,1,0}, e.swingYaw*DEG2RAD);
-        e.bladeStart = Vector3Add(epivot, ebase);
-        e.bladeEnd = Vector3Add(epivot, etip);
+template <EnemyType T>
+void UpdateEnemyGroup(float dt) {
+    for (int index : enemyGroups[T]) {
+        Enemy& e = enemies[index];
+        if (e.alive) UpdateEnemy<T>(e, index, dt);
     }
 }
 
+void UpdateEnemies(float dt) {
+    HEADLESS_SCOPE(HS_ENEMIES);
+    PROFILE_ZONE("UpdateEnemies");
+    std::fill(std::begin(aiLodCounts), std::end(aiLodCounts), 0);
+    AssignAttackSlots();
+    UpdateEnemyGroup<GRUNT>(dt);
+    UpdateEnemyGroup<TANK>(dt);
+    UpdateEnemyGroup<AGILE>(dt);
+    UpdateEnemyGroup<BOSS>(dt);
+    ResolveCrowd();
+}
+
 // ======================================================================
 // Hit Detection
 // ======================================================================
@@ -1188,8 +2919,8 @@ void ApplyEnemyHitToPlayer(const Enemy& e) {
     float knockMult = (e.type == BOSS) ? ((e.comboStep == 5) ? 1.8f : 1.3f)
                                       : (e.isHeavyAttack ? 1.5f : 1.0f);
 
-    int damage = (int)(e.attackDamage * dmgMult);
-    float poiseDmg = e.poiseDamage * poiseMult;
+    int damage = (int)(Archetype(e.type).attackDamage * dmgMult);
+    float poiseDmg = Archetype(e.type).poiseDamage * poiseMult;
 
     player.health -= damage;
     player.hitInvuln = 0.5f;
@@ -1274,7 +3005,7 @@ bool CheckPlayerAttackHitEnemy(Enemy& e) {
     if (e.stunTimer <= 0) {
         e.poise -= poiseDamage;
         if (e.poise <= 0) {
-            e.poise = e.maxPoise;
+            e.poise = Archetype(e.type).poise;
             e.stunTimer = 2.4f;
             e.velocity = Vector3Add(e.velocity, Vector3Scale(normToEnemy, 26.0f));
             poiseBreak = true;
@@ -1306,6 +3037,7 @@ bool CheckPlayerAttackHitEnemy(Enemy& e) {
 // Camera
 // ======================================================================
 void UpdateCamera(float dt) {
+    PROFILE_ZONE("UpdateCamera");
     Vector3 desiredTarget = Vector3Add(player.position, {0, 2.0f, 0});
 
     if (player.lockedTarget != -1 && enemies[player.lockedTarget].alive) {
@@ -1330,9 +3062,9 @@ void UpdateCamera(float dt) {
     if (player.shakeTimer > 0) {
         player.shakeTimer -= dt;
         float str = player.shakeTimer * 60.0f;
-        shake.x = GetRandomValue(-100,100)/1000.0f * str;
-        shake.y = GetRandomValue(-100,100)/1000.0f * str;
-        shake.z = GetRandomValue(-100,100)/1000.0f * str;
+        shake.x = fxRng.Range(-100,100)/1000.0f * str;
+        shake.y = fxRng.Range(-100,100)/1000.0f * str;
+        shake.z = fxRng.Range(-100,100)/1000.0f * str;
     }
 
     camera.position = Vector3Add(camPos, shake);
@@ -1343,32 +3075,43 @@ void UpdateCamera(float dt) {
 // Drawing
 // ======================================================================
 void Draw3DScene() {
+    PROFILE_ZONE("Draw3DScene");
     DrawPlane({0,-1.0f,0}, {600,600}, {45,40,55,255});
 
-    for (const auto& obs : obstacles) {
-        DrawCube(obs, 8.0f, 16.0f, 8.0f, DARKGRAY);
-        DrawCube(Vector3Add(obs, {0,9.0f,0}), 6.0f, 2.0f, 6.0f, GRAY);
+    if (!DrawStaticGeometry()) {
+        for (const auto& obs : obstacles) {
+            DrawCube(obs, 8.0f, 16.0f, 8.0f, DARKGRAY);
+            DrawCube(Vector3Add(obs, {0,9.0f,0}), 6.0f, 2.0f, 6.0f, GRAY);
+        }
     }
 
     // Exit portal only in level 1
     if (currentLevel == 1) {
         Color exitCol = exitActive ? GOLD : DARKGRAY;
-        DrawCube(Vector3Add(exitPosition, {0,6.0f,0}), 10.0f, 12.0f, 4.0f, Fade(exitCol, 0.6f));
-        DrawSphere(Vector3Add(exitPosition, {0,10.0f,0}), 4.0f, exitCol);
+        DrawPortalFrame(Fade(exitCol, 0.6f));
+        DrawQualitySphere(Vector3Add(exitPosition, {0,10.0f,0}), 4.0f, exitCol);
     }
 
-    DrawPlayer();
-    for (size_t i = 0; i < enemies.size(); i++) {
-        if (enemies[i].alive) DrawEnemy(enemies[i], (int)i);
+    {
+        PROFILE_ZONE("DrawActors");
+        DrawPlayer();
+        for (size_t i = 0; i < enemies.size(); i++) {
+            if (enemies[i].alive) DrawEnemy(enemies[i], (int)i);
+        }
+        FlushCharacterParts();
     }
 
-    for (const auto& p : particles) {
-        DrawSphere(p.position, p.size, p.color);
+    {
+        PROFILE_ZONE("DrawParticles");
+        for (const auto& p : particles) {
+            DrawInstance(sphereBatch, p.position, p.size, p.color);
+        }
+        FlushInstances(sphereBatch);
     }
 
     // Weapon trail
     for (size_t i = 1; i < weaponTrail.size(); i++) {
-        float alpha = 1.0f - (weaponTrail[i].time / 0.5f);
+        float alpha = 1.0f - (weaponTrail[i].time / Quality().trailLife);
         if (alpha <= 0) continue;
         Color c = player.powerReady ? Fade(ORANGE, alpha) : Fade(player.weapon.bladeColor, alpha*0.8f);
         DrawLine3D(weaponTrail[i-1].pos, weaponTrail[i].pos, c);
@@ -1376,19 +3119,19 @@ void Draw3DScene() {
     }
 }
 
-void AddWeaponTrailPoint() {
-    static float trailTimer = 0;
-    trailTimer += GetFrameTime();
-    if (trailTimer < 0.016f) return;
-    trailTimer = 0;
+void AddWeaponTrailPoint(float dt) {
+    trailSampleTimer += dt;
+    if (trailSampleTimer < TRAIL_SAMPLE_INTERVAL) return;
+    float elapsed = trailSampleTimer;
+    trailSampleTimer = 0;
 
     if (player.isAttacking || player.isCharging) {
         weaponTrail.push_back({player.bladeEnd, 0.0f});
     }
 
     for (auto it = weaponTrail.begin(); it != weaponTrail.end(); ) {
-        it->time += GetFrameTime();
-        if (it->time > 0.5f) {
+        it->time += elapsed;
+        if (it->time > Quality().trailLife) {
             it = weaponTrail.erase(it);
         } else {
             ++it;
@@ -1397,152 +3140,79 @@ void AddWeaponTrailPoint() {
 }
 
 void DrawPlayer() {
-    rlPushMatrix();
-    rlTranslatef(player.position.x, player.position.y, player.position.z);
-    rlRotatef(player.rotation, 0,1,0);
+    Vector3 pos = Vector3Lerp(player.prevPosition, player.position, renderAlpha);
+    Matrix root = MatrixMultiply(MatrixRotateY(LerpAngle(player.prevRotation, player.rotation, renderAlpha) * DEG2RAD),
+                                 MatrixTranslate(pos.x, pos.y, pos.z));
     if (player.isDead) {
-        rlRotatef(player.deathFallAngle, 1,0,0);
+        root = MatrixMultiply(MatrixRotateX(player.deathFallAngle * DEG2RAD), root);
     }
 
     Color bodyColor = {60, 80, 140, 255};
     if (player.isHealing) bodyColor = GOLD;
     if (player.staggerTimer > 0) bodyColor = Fade(YELLOW, 0.8f);
 
-    // Legs
-    DrawCylinderEx({-0.4f, -0.9f, 0}, {-0.4f, 1.0f, 0}, 0.5f, 0.4f, 12, DARKGRAY);
-    DrawCylinderEx({ 0.4f, -0.9f, 0}, { 0.4f, 1.0f, 0}, 0.5f, 0.4f, 12, DARKGRAY);
-    DrawSphere({-0.4f, -0.9f, 0}, 0.52f, DARKGRAY);
-    DrawSphere({ 0.4f, -0.9f, 0}, 0.52f, DARKGRAY);
-
-    // Torso
-    DrawCube({0, 0.9f, 0}, 1.7f, 2.9f, 1.3f, bodyColor);
-    DrawCube({0, 1.1f, 0.45f}, 1.9f, 2.2f, 0.5f, Fade(bodyColor, 0.7f));
-
-    // Arms & Head
-    DrawSphere({-1.0f, 1.9f, 0}, 0.55f, bodyColor);
-    DrawSphere({ 1.0f, 1.9f, 0}, 0.55f, bodyColor);
-    DrawSphere({0, 2.4f, 0}, 0.62f, Fade(bodyColor, 0.9f));
-    DrawCylinderEx({0, 2.4f, 0}, {0, 3.1f, 0}, 0.75f, 0.55f, 16, DARKGRAY);
+    float length = player.weapon.length;
+    if (characterMeshes.ready && length != characterMeshes.bladeLength) BakePlayerBlade(length);
 
-    // Left arm (parry pose)
-    rlPushMatrix();
-    rlTranslatef(-0.9f, 1.4f, 0);
     float leftAngle = player.isParrying ? 80.0f : -25.0f;
-    rlRotatef(leftAngle, 1, 0, 0);
-    DrawCylinderEx({0, 0, 0}, {0, -1.4f, 0}, 0.35f, 0.3f, 12, bodyColor);
-    DrawSphere({0, -1.4f, 0}, 0.38f, DARKGRAY);
-    rlPopMatrix();
-
-    // Weapon arm
+    Matrix weapon = SwingFrame(root, {0.65f, 1.65f, 0.4f},
+                               Lerp(player.prevSwingYaw, player.swingYaw, renderAlpha),
+                               Lerp(player.prevSwingPitch, player.swingPitch, renderAlpha));
+    QueueRigFrame(RIG_PLAYER, FRAME_ROOT, root, bodyColor);
+    QueueRigFrame(RIG_PLAYER, FRAME_ARM, SwingFrame(root, {-0.9f, 1.4f, 0}, 0.0f, leftAngle), bodyColor);
+    QueueRigFrame(RIG_PLAYER, FRAME_WEAPON, weapon, player.weapon.bladeColor);
+    FlushCharacterParts();  // The blade has to be down before its translucent glow
+
+    // Edge highlights and glow pulse every frame, so they stay immediate
     rlPushMatrix();
-    rlTranslatef(0.65f, 1.65f, 0.4f);
-    rlRotatef(player.swingYaw, 0, 1, 0);
-    rlRotatef(player.swingPitch, 1, 0, 0);
+    rlMultMatrixf(MatrixToFloat(weapon));
+    DrawLine3D({ BLADE_THICKNESS/2 + 0.04f, 0, 0}, { BLADE_THICKNESS/2 + 0.04f, 0, length}, WHITE);
+    DrawLine3D({-BLADE_THICKNESS/2 - 0.04f, 0, 0}, {-BLADE_THICKNESS/2 - 0.04f, 0, length}, WHITE);
 
-    // Handle
-    DrawCylinderEx({0, -0.4f, 0}, {0, -1.4f, 0}, 0.22f, 0.22f, 16, {139, 69, 19, 255});
-    DrawSphere({0, -1.6f, 0}, 0.35f, GRAY);
-    DrawCube({0, -0.2f, 0}, 0.5f, 0.4f, 1.0f, GRAY);
-    DrawCylinderEx({-1.4f, -0.2f, 0}, {1.4f, -0.2f, 0}, 0.28f, 0.28f, 12, GRAY);
-
-    // Blade
-    float length = player.weapon.length;
-    float thickness = 0.18f;
-    float baseWidth = 1.3f;
-    float tipWidth = 0.7f;
-    Color bladeCol = player.weapon.bladeColor;
-
-    DrawCube({0, 0.0f, length * 0.4f}, thickness, baseWidth, length * 0.8f, bladeCol);
-    DrawCube({0, 0.0f, length - tipWidth * 0.4f}, thickness, tipWidth, length * 0.4f, bladeCol);
-    DrawCube({0, 0.04f, length * 0.5f}, thickness * 0.6f, baseWidth * 0.55f, length * 0.9f, Fade(bladeCol, 0.7f));
-    DrawLine3D({ thickness/2 + 0.04f, 0, 0}, { thickness/2 + 0.04f, 0, length}, WHITE);
-    DrawLine3D({-thickness/2 - 0.04f, 0, 0}, {-thickness/2 - 0.04f, 0, length}, WHITE);
-
-    // Glow
     if (player.weapon.hasGlow || player.isCharging || player.powerReady) {
         float pulse = 0.4f + 0.4f * sinf(GetTime() * 12.0f);
         float alpha = player.powerReady ? 0.9f : pulse;
         Color glow = player.powerReady ? ORANGE : player.weapon.bladeColor;
-        DrawCube({0, 0.0f, length * 0.5f}, thickness * 2.2f, baseWidth * 1.4f, length * 1.15f, Fade(glow, alpha));
+        DrawCube({0, 0.0f, length * 0.5f}, BLADE_THICKNESS * 2.2f, BLADE_BASE_WIDTH * 1.4f, length * 1.15f,
+                 Fade(glow, alpha));
     }
-
-    rlPopMatrix();
     rlPopMatrix();
 }
 
+// Queues the enemy's parts; Draw3DScene() flushes once every enemy is in
 void DrawEnemy(const Enemy& e, int index) {
-    rlPushMatrix();
-    rlTranslatef(e.position.x, e.position.y, e.position.z);
-    rlRotatef(e.rotation, 0,1,0);
-    rlScalef(e.scale, e.scale, e.scale);
-
-    Color body = e.bodyColor;
+    const EnemyPrevPose& prev = enemyPrevPose[index];
+    Vector3 pos = Vector3Lerp(prev.position, e.position, renderAlpha);
+    float scale = Archetype(e.type).scale;
+    Matrix root = MatrixMultiply(MatrixMultiply(MatrixScale(scale, scale, scale),
+                                                MatrixRotateY(LerpAngle(prev.rotation, e.rotation, renderAlpha) * DEG2RAD)),
+                                 MatrixTranslate(pos.x, pos.y, pos.z));
+
+    Color body = Archetype(e.type).bodyColor;
     if (e.stunTimer > 0) body = YELLOW;
     if (e.isBlocking) body = Fade(SKYBLUE, 1.2f);
     if (e.isDodging) body = LIME;
 
-    if (e.type == BOSS) {
-        body = {200, 40, 60, 255};
-        DrawCube({0, 1.2f, 0}, 2.4f, 3.8f, 1.8f, body);
-        DrawSphere({0, 3.8f, 0}, 0.9f, body);
-        DrawCylinderEx({0, 3.8f, 0}, {0, 5.2f, 0}, 1.1f, 0.7f, 16, DARKGRAY);
-        DrawCylinderEx({-0.8f, 4.2f, 0}, {-1.4f, 5.8f, 0}, 0.3f, 0.1f, 8, GRAY);
-        DrawCylinderEx({0.8f, 4.2f, 0}, {1.4f, 5.8f, 0}, 0.3f, 0.1f, 8, GRAY);
-        DrawCube({0, 1.8f, -0.8f}, 2.6f, 3.8f, 0.3f, Fade(RED, 0.8f));
-    } else {
-        DrawCylinderEx({-0.4f, -0.9f, 0}, {-0.4f, 1.0f, 0}, 0.5f, 0.4f, 12, DARKGRAY);
-        DrawCylinderEx({ 0.4f, -0.9f, 0}, { 0.4f, 1.0f, 0}, 0.5f, 0.4f, 12, DARKGRAY);
-        DrawCube({0, 0.9f, 0}, 1.7f, 2.9f, 1.3f, body);
-        DrawSphere({0, 2.4f, 0}, 0.62f, Fade(body, 0.9f));
-
-        if (e.type == GRUNT) {
-            DrawCylinderEx({0, 2.4f, 0}, {0, 3.1f, 0}, 0.75f, 0.55f, 16, MAROON);
-            DrawCylinderEx({0, 3.3f, 0}, {0, 4.2f, 0}, 0.3f, 0.0f, 8, RED);
-        } else if (e.type == TANK) {
-            DrawCube({0, 2.7f, 0}, 1.5f, 1.8f, 1.5f, DARKGRAY);
-        } else if (e.type == AGILE) {
-            DrawCylinderEx({0, 2.4f, 0}, {0, 3.6f, 0}, 0.85f, 0.55f, 16, DARKGREEN);
-        }
-    }
-
-    // Weapon
-    rlPushMatrix();
-    rlTranslatef(0.65f, 1.65f, 0.4f);
-    rlRotatef(e.swingYaw, 0, 1, 0);
-    rlRotatef(e.swingPitch, 1, 0, 0);
-    float bladeLen = (e.type == BOSS) ? 9.5f : 5.8f;
-    DrawCylinderEx({0, -0.3f, 0}, {0, -1.0f, 0}, 0.18f, 0.18f, 12, BROWN);
-    DrawCylinderEx({-0.9f, -0.1f, 0}, {0.9f, -0.1f, 0}, 0.22f, 0.22f, 10, GRAY);
-    DrawCube({0, 0.0f, 2.9f}, 0.14f, 0.7f, bladeLen, LIGHTGRAY);
-    rlPopMatrix();
-
-    // Tank shield
+    CharacterRig rig = EnemyRig(e.type);
+    QueueRigFrame(rig, FRAME_ROOT, root, body);
+    QueueRigFrame(rig, FRAME_WEAPON,
+                  SwingFrame(root, {0.65f, 1.65f, 0.4f}, Lerp(prev.swingYaw, e.swingYaw, renderAlpha),
+                             Lerp(prev.swingPitch, e.swingPitch, renderAlpha)), WHITE);
     if (e.type == TANK) {
-        rlPushMatrix();
-        rlTranslatef(-0.9f, 1.6f, 0.4f);
-        rlRotatef(90, 0, 1, 0);
         float blockAngle = e.isBlocking ? 30.0f : -30.0f;
-        rlRotatef(blockAngle, 1, 0, 0);
-        float height = 3.8f;
-        float width = 2.0f;
-        float thick = 0.4f;
-        DrawCube({0, 0, 0}, width, height, thick, Fade(body, 0.8f));
-        DrawCube({0, 0, thick/2 + 0.08f}, width + 0.3f, height + 0.3f, 0.15f, DARKGRAY);
-        DrawCylinder({0, 0, thick/2 + 0.1f}, 0.55f, 0.25f, 2, 20, GRAY);
-        DrawCube({0, 0.9f, thick/2 + 0.15f}, 0.25f, 1.8f, 0.1f, GOLD);
-        DrawCube({0, 0, thick/2 + 0.15f}, 1.4f, 0.25f, 0.1f, GOLD);
-        rlPopMatrix();
+        QueueRigFrame(rig, FRAME_SHIELD, SwingFrame(root, {-0.9f, 1.6f, 0.4f}, 90.0f, blockAngle), body);
     }
 
     // Lock-on indicator
     if (index == player.lockedTarget) {
         float pulse = 0.6f + 0.4f * sinf(GetTime() * 10.0f);
         Color lockCol = Fade(GOLD, pulse);
+        rlPushMatrix();
+        rlMultMatrixf(MatrixToFloat(root));
         DrawCircle3D({0, 1.5f, 0}, 3.5f, {1,0,0}, 90, lockCol);
         DrawCircle3D({0, 4.0f, 0}, 2.5f, {1,0,0}, 90, lockCol);
+        rlPopMatrix();
     }
-
-    rlPopMatrix();
 }
 
 // ======================================================================
@@ -1588,11 +3258,31 @@ void DrawHUD() {
     // Boss health bar
     if (player.lockedTarget != -1 && enemies[player.lockedTarget].type == BOSS && enemies[player.lockedTarget].alive) {
         Enemy& boss = enemies[player.lockedTarget];
-        float bossRatio = (float)boss.health / boss.maxHealth;
+        float bossRatio = (float)boss.health / Archetype(BOSS).health;
         DrawRectangle(SCREEN_WIDTH/2 - 310, 50, 620, 40, Fade(BLACK, 0.8f));
         DrawRectangle(SCREEN_WIDTH/2 - 300, 60, 600 * bossRatio, 20, RED);
         DrawText("THE SCROLLKEEPER", SCREEN_WIDTH/2 - MeasureText("THE SCROLLKEEPER", 50)/2, 20, 50, GOLD);
     }
+
+    // Debug overlay (F3)
+    if (showDebugOverlay) {
+        DrawRectangle(SCREEN_WIDTH - 430, SCREEN_HEIGHT - 214, 410, 194, Fade(BLACK, 0.7f));
+        DrawText(TextFormat("SEED %llu  PILLARS %d", (unsigned long long)rngSeed, (int)obstacles.size()),
+                 SCREEN_WIDTH - 420, SCREEN_HEIGHT - 204, 20, LIME);
+        DrawText(TextFormat("STATIC %d / %d CHUNKS DRAWN", staticGeometry.chunksDrawn, staticGeometry.chunksBuilt),
+                 SCREEN_WIDTH - 420, SCREEN_HEIGHT - 178, 20, LIME);
+        DrawText(TextFormat("AI LOD  FULL %d  MID %d  FAR %d  SLOTS %d/%d",
+                            aiLodCounts[AI_LOD_FULL], aiLodCounts[AI_LOD_MID], aiLodCounts[AI_LOD_FAR],
+                            attackSlotsTaken, ATTACK_SLOTS),
+                 SCREEN_WIDTH - 420, SCREEN_HEIGHT - 152, 20, LIME);
+        DrawText(TextFormat("INSTANCED %d IN %d DRAWS", instancesDrawn, instanceDrawCalls),
+                 SCREEN_WIDTH - 420, SCREEN_HEIGHT - 126, 20, LIME);
+        DrawText(TextFormat("PARTICLES %d / %d  (peak %d)", particles.count, MAX_PARTICLES, particles.peakCount),
+                 SCREEN_WIDTH - 420, SCREEN_HEIGHT - 100, 20, LIME);
+        DrawText(TextFormat("POOL %.1f KB  DROPPED %d", sizeof(ParticlePool) / 1024.0f, particles.dropped),
+                 SCREEN_WIDTH - 420, SCREEN_HEIGHT - 74, 20, LIME);
+        DrawText(TextFormat("FPS %d  QUALITY %s", GetFPS(), Quality().name), SCREEN_WIDTH - 420, SCREEN_HEIGHT - 48, 20, LIME);
+    }
 }
 
 void DrawTitleScreen() {
@@ -1612,6 +3302,8 @@ void DrawTitleScreen() {
 
     DrawText("Click or ENTER to Begin", SCREEN_WIDTH/2 - MeasureText("Click or ENTER to Begin", 50)/2,
              SCREEN_HEIGHT - 140, 50, WHITE);
+    const char* hordeText = TextFormat("H - Horde: the field with %d foes", HORDE_ENEMY_COUNT);
+    DrawText(hordeText, SCREEN_WIDTH/2 - MeasureText(hordeText, 30)/2, SCREEN_HEIGHT - 80, 30, ORANGE);
 }
 
 void DrawDeathScreen() {
@@ -1647,43 +3339,48 @@ void DrawVictoryScreen() {
 // Particles
 // ======================================================================
 void SpawnBloodParticles(Vector3 pos, int count) {
+    count = QualityParticles(count);
     for (int i = 0; i < count; i++) {
-        Particle p{};
-        p.position = pos;
-        p.velocity = {GetRandomValue(-100,100)/20.0f,
-                      GetRandomValue(40,140)/20.0f,
-                      GetRandomValue(-100,100)/20.0f};
-        p.lifetime = p.maxLife = GetRandomValue(40,90)/100.0f;
-        p.color = Fade(RED, 0.9f);
-        p.size = GetRandomValue(4,12)/10.0f;
-        particles.push_back(p);
+        Particle* p = particles.Spawn();
+        if (!p) break;
+        p->position = pos;
+        p->velocity = {fxRng.Range(-100,100)/20.0f,
+                       fxRng.Range(40,140)/20.0f,
+                       fxRng.Range(-100,100)/20.0f};
+        p->lifetime = p->maxLife = fxRng.Range(40,90)/100.0f;
+        p->color = Fade(RED, 0.9f);
+        p->size = fxRng.Range(4,12)/10.0f;
     }
 }
 
 void SpawnHitSparks(Vector3 pos, int count) {
+    count = QualityParticles(count);
     for (int i = 0; i < count; i++) {
-        Particle p{};
-        p.position = pos;
-        p.velocity = {GetRandomValue(-120,120)/15.0f,
-                      GetRandomValue(60,180)/15.0f,
-                      GetRandomValue(-120,120)/15.0f};
-        p.lifetime = p.maxLife = GetRandomValue(30,70)/100.0f;
-        p.color = Fade(YELLOW, 0.95f);
-        p.size = GetRandomValue(3,9)/10.0f;
-        particles.push_back(p);
+        Particle* p = particles.Spawn();
+        if (!p) break;
+        p->position = pos;
+        p->velocity = {fxRng.Range(-120,120)/15.0f,
+                       fxRng.Range(60,180)/15.0f,
+                       fxRng.Range(-120,120)/15.0f};
+        p->lifetime = p->maxLife = fxRng.Range(30,70)/100.0f;
+        p->color = Fade(YELLOW, 0.95f);
+        p->size = fxRng.Range(3,9)/10.0f;
     }
 }
 
 void UpdateParticles(float dt) {
-    for (auto it = particles.begin(); it != particles.end(); ) {
-        it->lifetime -= dt;
-        if (it->lifetime <= 0) {
-            it = particles.erase(it);
+    HEADLESS_SCOPE(HS_PARTICLES);
+    PROFILE_ZONE("UpdateParticles");
+    for (int i = 0; i < particles.count; ) {
+        Particle& p = particles.items[i];
+        p.lifetime -= dt;
+        if (p.lifetime <= 0) {
+            particles.Kill(i);  // Swapped-in particle is processed next
             continue;
         }
-        it->position = Vector3Add(it->position, Vector3Scale(it->velocity, dt));
-        it->velocity.y -= 3.5f * dt;
-        ++it;
+        p.position = Vector3Add(p.position, Vector3Scale(p.velocity, dt));
+        p.velocity.y -= 3.5f * dt;
+        i++;
     }
 }
 
@@ -1691,6 +3388,7 @@ void UpdateParticles(float dt) {
 // Utility
 // ======================================================================
 bool CanSeePlayer(const Enemy& e) {
+    HEADLESS_SCOPE(HS_COLLISION);
     Vector3 eye = Vector3Add(e.position, {0,2.4f,0});
     Vector3 target = Vector3Add(player.position, {0,1.6f,0});
     Vector3 dir = Vector3Subtract(target, eye);
@@ -1701,11 +3399,90 @@ bool CanSeePlayer(const Enemy& e) {
     float dot = Vector3DotProduct(Vector3Normalize(dir), forward);
     if (dot < cosf(65.0f * DEG2RAD)) return false;
 
-    Ray ray{eye, Vector3Normalize(dir)};
-    for (const auto& obs : obstacles) {
-        BoundingBox box = {Vector3Subtract(obs, {5,7,5}), Vector3Add(obs, {5,7,5})};
-        RayCollision col = GetRayCollisionBox(ray, box);
-        if (col.hit && col.distance < dist - 0.8f) return false;
+    return !obstacleGrid.SegmentBlocked(eye, target, 0.8f);
+}
+
+// Shortest-arc interpolation between two angles in degrees
+float LerpAngle(float from, float to, float t) {
+    return from + remainderf(to - from, 360.0f) * t;
+}
+
+// ======================================================================
+// Headless Benchmark
+// ======================================================================
+#ifdef HEADLESS
+// Deterministic input script: walk a square, keep turning, attack,
+// roll, parry and heal on fixed frame intervals; restart when dead.
+void HeadlessScriptInput(int frame) {
+    std::memset(headless.keyDown, 0, sizeof(headless.keyDown));
+    std::memset(headless.keyPressed, 0, sizeof(headless.keyPressed));
+    std::memset(headless.mouseDown, 0, sizeof(headless.mouseDown));
+    std::memset(headless.mouseReleased, 0, sizeof(headless.mouseReleased));
+    headless.mouseDelta = {2.0f, 0.0f};
+
+    const int walkKeys[4] = {KEY_W, KEY_D, KEY_S, KEY_A};
+    headless.keyDown[walkKeys[(frame / 90) % 4]] = true;
+    if (frame % 45 < 12) headless.mouseDown[MOUSE_BUTTON_LEFT] = true;
+    if (frame % 45 == 12) headless.mouseReleased[MOUSE_BUTTON_LEFT] = true;
+    if (frame % 150 == 80) headless.keyPressed[KEY_LEFT_SHIFT] = true;
+    if (frame % 200 == 130) headless.keyPressed[KEY_LEFT_CONTROL] = true;
+    if (frame % 240 == 0) headless.keyPressed[KEY_F] = true;
+    if (player.health < MAX_PLAYER_HEALTH / 3) headless.keyPressed[KEY_E] = true;
+    if (gameState == TITLE_SCREEN) headless.keyPressed[hordeMode ? KEY_H : KEY_ENTER] = true;
+    if (gameState == DEAD) headless.keyPressed[KEY_R] = true;
+}
+
+int main(int argc, char** argv) {
+    int frames = 3600;
+    uint64_t seed = 1;
+    const char* tracePath = nullptr;  // Chrome trace output, PROFILE=1 builds only
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--frames") == 0) frames = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--seed") == 0) seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--entities") == 0) levelOneEnemyCount = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--horde") == 0) hordeMode = std::atoi(argv[i + 1]) != 0;
+        else if (std::strcmp(argv[i], "--trace") == 0) tracePath = argv[i + 1];
     }
-    return true;
-}
\ No newline at end of file
+
+    SeedRandom(seed);
+    InitGame();
+    currentLevel = 1;
+    ResetLevel();
+
+    double maxFrameMs = 0.0;
+    for (headless.frame = 0; headless.frame < frames; headless.frame++) {
+        PROFILE_FRAME();
+        HeadlessScriptInput(headless.frame);
+        auto start = std::chrono::steady_clock::now();
+        bool running = UpdateFrame(headless.frameTime);
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        headless.systemMs[HS_UPDATE] += ms.count();
+        maxFrameMs = std::max(maxFrameMs, ms.count());
+        if (!running || gameState == VICTORY) break;
+    }
+
+    int alive = 0;
+    for (const auto& e : enemies) if (e.alive) alive++;
+    int ran = std::max(headless.frame, 1);
+    printf("{\"game\":\"ashes\",\"frames\":%d,\"seed\":%llu,\"entities\":%d,"
+           "\"maxFrameMs\":%.4f,\"systems\":{", ran, (unsigned long long)seed,
+           hordeMode ? HORDE_ENEMY_COUNT : levelOneEnemyCount, maxFrameMs);
+    for (int i = 0; i < HS_COUNT; i++) {
+        printf("%s\"%s\":{\"totalMs\":%.4f,\"avgUs\":%.3f}", i ? "," : "", HEADLESS_SYSTEM_NAMES[i],
+               headless.systemMs[i], headless.systemMs[i] * 1000.0 / ran);
+    }
+    // Record bytes an enemy update streams: the hot Enemy every time, plus
+    // its EnemyMemory on the ticks it thinks
+    double thinkShare = (double)headless.enemyThinks / std::max(headless.enemyUpdates, 1LL);
+    printf("},\"enemyLayout\":{\"hotBytes\":%zu,\"memoryBytes\":%zu,\"prevPoseBytes\":%zu,"
+           "\"thinkShare\":%.3f,\"bytesPerUpdate\":%.1f}", sizeof(Enemy), sizeof(EnemyMemory),
+           sizeof(EnemyPrevPose), thinkShare, sizeof(Enemy) + thinkShare * sizeof(EnemyMemory));
+    printf(",\"state\":{\"level\":%d,\"alive\":%d,\"health\":%d}}\n", currentLevel, alive, player.health);
+#ifdef ENABLE_PROFILER
+    if (tracePath && !ProfileWriteTrace(tracePath)) fprintf(stderr, "could not write %s\n", tracePath);
+#else
+    (void)tracePath;
+#endif
+    return 0;
+}
+#endif
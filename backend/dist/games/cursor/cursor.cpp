@@ -2,45 +2,136 @@
 #include "raymath.h"
 #include "rlgl.h"
 #include <atomic>
-#include <condition_variable>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
-#include <deque>
-#include <functional>
-#include <future>
-#include <mutex>
-#include <queue>
+#include <ctime>
+#include <memory>
 #include <thread>
+#include <vector>
+
+// --- Headless Build (make headless) ---
+// Compiled with -DHEADLESS, no window or GL context is created. Input and
+// clock queries are redirected to a scripted state driven by the headless
+// main(), which steps UpdateGame for N frames and prints timings as JSON.
+// UpdateGame is a fixed pipeline of joined phases, so timing is done with
+// phase marks on the main thread: each mark closes the running phase.
+#ifdef HEADLESS
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+enum HeadlessSystem {
+  HS_NONE = -1,
+  HS_UPDATE,
+  HS_ENEMIES,
+  HS_COLLISION,
+  HS_PARTICLES,
+  HS_COUNT
+};
+static const char *const HEADLESS_SYSTEM_NAMES[HS_COUNT] = {
+    "update", "enemies", "collision", "particles"};
+
+struct HeadlessState {
+  int frame = 0;
+  float frameTime = 1.0f / 60.0f;
+  bool keyDown[512] = {};
+  bool keyPressed[512] = {};
+  bool mouseDown[8] = {};
+  Vector3 aimPoint = {0, 0, 0};
+  double systemMs[HS_COUNT] = {};
+  HeadlessSystem phase = HS_NONE;
+  std::chrono::steady_clock::time_point phaseStart;
+};
+static HeadlessState headless;
 
-// --- Thread-Safe Atomic Wrapper for Vectors ---
-template <typename T> struct AtomicWrapper {
-  std::atomic<T> val;
-  AtomicWrapper() : val(T{}) {}
-  AtomicWrapper(T v) : val(v) {}
-  AtomicWrapper(const AtomicWrapper &o) : val(o.val.load()) {}
-  AtomicWrapper &operator=(const AtomicWrapper &o) {
-    val.store(o.val.load());
-    return *this;
-  }
-  AtomicWrapper &operator=(T v) {
-    val.store(v);
-    return *this;
-  }
-  operator T() const { return val.load(); }
-  T operator++(int) { return val.fetch_add(1); }
-  T operator--(int) { return val.fetch_sub(1); }
-  T operator+=(T v) {
-    T expected = val.load();
-    while (!val.compare_exchange_weak(expected, expected + v))
-      ;
-    return expected + v;
-  }
-  T operator-=(T v) {
-    T expected = val.load();
-    while (!val.compare_exchange_weak(expected, expected - v))
-      ;
-    return expected - v;
+static void HeadlessPhase(HeadlessSystem system) {
+  auto now = std::chrono::steady_clock::now();
+  if (headless.phase != HS_NONE) {
+    std::chrono::duration<double, std::milli> ms = now - headless.phaseStart;
+    headless.systemMs[headless.phase] += ms.count();
   }
-};
+  headless.phase = system;
+  headless.phaseStart = now;
+}
+
+#define HEADLESS_PHASE(system) HeadlessPhase(system)
+
+#define IsKeyDown(key) (headless.keyDown[(key) & 511])
+#define IsKeyPressed(key) (headless.keyPressed[(key) & 511])
+#define IsMouseButtonDown(button) (headless.mouseDown[(button) & 7])
+#define GetMouseRay(position, cam)                                             \
+  (Ray{Vector3Add(headless.aimPoint, {0, 50.0f, 0}), {0, -1.0f, 0}})
+#define GetFrameTime() (headless.frameTime)
+#define GetTime() ((double)headless.frame * headless.frameTime)
+#else
+#define HEADLESS_PHASE(system)
+#endif
+
+// --- SIMD Lanes (AVX / SSE2 / WASM SIMD128 / scalar fallback) ---
+// Just enough of a float vector to run the bullet kernels N lanes at a time.
+// VMask* return one bit per lane, lane 0 in bit 0.
+#if defined(__AVX__)
+#include <immintrin.h>
+constexpr int SIMD_LANES = 8;
+typedef __m256 vfloat;
+static inline vfloat VLoad(const float *p) { return _mm256_load_ps(p); }
+static inline void VStore(float *p, vfloat v) { _mm256_store_ps(p, v); }
+static inline vfloat VSet(float f) { return _mm256_set1_ps(f); }
+static inline vfloat VAdd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+static inline vfloat VSub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+static inline vfloat VMul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+static inline vfloat VMin(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+static inline vfloat VMax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+static inline unsigned VMaskLess(vfloat a, vfloat b) {
+  return (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ));
+}
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+constexpr int SIMD_LANES = 4;
+typedef __m128 vfloat;
+static inline vfloat VLoad(const float *p) { return _mm_load_ps(p); }
+static inline void VStore(float *p, vfloat v) { _mm_store_ps(p, v); }
+static inline vfloat VSet(float f) { return _mm_set1_ps(f); }
+static inline vfloat VAdd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+static inline vfloat VSub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+static inline vfloat VMul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+static inline vfloat VMin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+static inline vfloat VMax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+static inline unsigned VMaskLess(vfloat a, vfloat b) {
+  return (unsigned)_mm_movemask_ps(_mm_cmplt_ps(a, b));
+}
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+constexpr int SIMD_LANES = 4;
+typedef v128_t vfloat;
+static inline vfloat VLoad(const float *p) { return wasm_v128_load(p); }
+static inline void VStore(float *p, vfloat v) { wasm_v128_store(p, v); }
+static inline vfloat VSet(float f) { return wasm_f32x4_splat(f); }
+static inline vfloat VAdd(vfloat a, vfloat b) { return wasm_f32x4_add(a, b); }
+static inline vfloat VSub(vfloat a, vfloat b) { return wasm_f32x4_sub(a, b); }
+static inline vfloat VMul(vfloat a, vfloat b) { return wasm_f32x4_mul(a, b); }
+static inline vfloat VMin(vfloat a, vfloat b) { return wasm_f32x4_pmin(a, b); }
+static inline vfloat VMax(vfloat a, vfloat b) { return wasm_f32x4_pmax(a, b); }
+static inline unsigned VMaskLess(vfloat a, vfloat b) {
+  return (unsigned)wasm_i32x4_bitmask(wasm_f32x4_lt(a, b));
+}
+#else
+constexpr int SIMD_LANES = 1;
+typedef float vfloat;
+static inline vfloat VLoad(const float *p) { return *p; }
+static inline void VStore(float *p, vfloat v) { *p = v; }
+static inline vfloat VSet(float f) { return f; }
+static inline vfloat VAdd(vfloat a, vfloat b) { return a + b; }
+static inline vfloat VSub(vfloat a, vfloat b) { return a - b; }
+static inline vfloat VMul(vfloat a, vfloat b) { return a * b; }
+static inline vfloat VMin(vfloat a, vfloat b) { return a < b ? a : b; }
+static inline vfloat VMax(vfloat a, vfloat b) { return a > b ? a : b; }
+static inline unsigned VMaskLess(vfloat a, vfloat b) { return a < b ? 1u : 0u; }
+#endif
+constexpr unsigned SIMD_LANE_MASK = (1u << SIMD_LANES) - 1u;
 
 // Forward Declarations
 void QueueExplosion(Vector3 pos, Color color);
@@ -51,13 +142,6 @@ void SpawnExplosion(Vector3 pos, Color color);
 void SpawnBullet(Vector3 pos, Vector3 vel);
 void SpawnEnemyBullet(Vector3 pos, Vector3 vel);
 
-// --- Atomic Helper for Floats ---
-void AtomicMax(std::atomic<float> &atom, float val) {
-  float cur = atom.load();
-  while (cur < val && !atom.compare_exchange_weak(cur, val))
-    ;
-}
-
 // --- Command Buffer for Thread-Safe Effects ---
 struct EffectCommand {
   enum Type { EXPLOSION, SOUND, TEXT };
@@ -68,24 +152,83 @@ struct EffectCommand {
   Sound sfx;
 };
 
-static std::deque<EffectCommand> effectBuffer;
-static std::mutex bufferMutex;
+// Bounded multi-producer / single-consumer ring (Vyukov sequence slots).
+// Workers claim a slot with one CAS on the tail; the main thread drains it in
+// ProcessEffectBuffer(). When full, the command is dropped and counted.
+constexpr int EFFECT_RING_SIZE = 1024; // Power of 2
+
+class EffectRing {
+public:
+  EffectRing() {
+    for (int i = 0; i < EFFECT_RING_SIZE; ++i)
+      slots[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  bool Push(const EffectCommand &cmd) {
+    unsigned pos = tail.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot &slot = slots[pos & (EFFECT_RING_SIZE - 1)];
+      unsigned seq = slot.seq.load(std::memory_order_acquire);
+      int diff = (int)(seq - pos);
+      if (diff == 0) {
+        if (tail.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed)) {
+          slot.cmd = cmd;
+          slot.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        overflow.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consumer only
+  bool Pop(EffectCommand &out) {
+    Slot &slot = slots[head & (EFFECT_RING_SIZE - 1)];
+    if (slot.seq.load(std::memory_order_acquire) != head + 1)
+      return false;
+    out = slot.cmd;
+    slot.seq.store(head + EFFECT_RING_SIZE, std::memory_order_release);
+    ++head;
+    return true;
+  }
+
+  int Overflow() const { return overflow.load(std::memory_order_relaxed); }
+
+  // Consumer only. Commands waiting to be popped (claimed or published).
+  int Depth() const {
+    return (int)(tail.load(std::memory_order_relaxed) - head);
+  }
+
+private:
+  struct Slot {
+    std::atomic<unsigned> seq;
+    EffectCommand cmd;
+  };
+  alignas(64) std::atomic<unsigned> tail{0};
+  alignas(64) unsigned head = 0;
+  std::atomic<int> overflow{0};
+  Slot slots[EFFECT_RING_SIZE];
+};
+
+static EffectRing effectBuffer;
 
 void QueueExplosion(Vector3 pos, Color color) {
-  std::lock_guard<std::mutex> lock(bufferMutex);
-  effectBuffer.push_back({EffectCommand::EXPLOSION, pos, color, "", {0}});
+  effectBuffer.Push({EffectCommand::EXPLOSION, pos, color, "", {0}});
 }
 
 void QueueSound(Sound sfx) {
-  std::lock_guard<std::mutex> lock(bufferMutex);
-  effectBuffer.push_back({EffectCommand::SOUND, {0}, WHITE, "", sfx});
+  effectBuffer.Push({EffectCommand::SOUND, {0}, WHITE, "", sfx});
 }
 
 void QueueText(Vector3 pos, const char *text, Color color) {
-  std::lock_guard<std::mutex> lock(bufferMutex);
   EffectCommand cmd = {EffectCommand::TEXT, pos, color, "", {0}};
   strncpy(cmd.text, text, 31);
-  effectBuffer.push_back(cmd);
+  effectBuffer.Push(cmd);
 }
 
 // --- Constants ---
@@ -95,6 +238,8 @@ constexpr int MAX_BULLETS = 1000;
 constexpr int MAX_ENEMIES = 100;
 constexpr int MAX_PARTICLES = 2000;
 constexpr int MAX_FLOATING_TEXTS = 50;
+constexpr float PLAYER_BULLET_RADIUS = 0.2f;
+constexpr float ENEMY_BULLET_RADIUS = 0.25f;
 
 // --- Enums ---
 enum GameScreen {
@@ -111,11 +256,11 @@ struct Player {
   Vector3 position;
   Vector3 velocity;
   float speed;
-  AtomicWrapper<int> health;
+  int health;
   int maxHealth;
 
   // RPG Stats
-  AtomicWrapper<int> xp;
+  int xp;
   int level;
   int xpToNextLevel;
   float critChance;  // 0.0 to 1.0
@@ -136,27 +281,117 @@ struct Player {
   float virtues[4]; // 0:Efficiency, 1:Robustness, 2:Concurrency, 3:Memory
 };
 
-struct Bullet {
-  Vector3 position;
-  Vector3 velocity;
+// --- Bullet Pool (Structure of Arrays) ---
+// Hot fields live in separate aligned float arrays so the update kernels load
+// SIMD_LANES bullets per instruction; liveness is one bit per slot. Radius and
+// colour are per pool, not per bullet. Capacity is padded to whole 64-bit
+// mask words so a SIMD block never runs past the end.
+constexpr int BULLET_WORDS = (MAX_BULLETS + 63) / 64;
+constexpr int BULLET_CAPACITY = BULLET_WORDS * 64;
+constexpr float BULLET_MAX_DIST = 100.0f;
+
+struct BulletPool {
+  alignas(32) float x[BULLET_CAPACITY];
+  alignas(32) float y[BULLET_CAPACITY];
+  alignas(32) float z[BULLET_CAPACITY];
+  alignas(32) float vx[BULLET_CAPACITY];
+  alignas(32) float vy[BULLET_CAPACITY];
+  alignas(32) float vz[BULLET_CAPACITY];
+  std::atomic<uint64_t> activeMask[BULLET_WORDS];
+  int nextWord; // Allocation cursor; slots are handed out round-robin
   float radius;
-  AtomicWrapper<bool> active;
   Color color;
-  bool isEnemyBullet;
+  bool isEnemy;
+
+  void Reset(float r, Color c, bool enemy) {
+    memset(x, 0, sizeof(x));
+    memset(y, 0, sizeof(y));
+    memset(z, 0, sizeof(z));
+    memset(vx, 0, sizeof(vx));
+    memset(vy, 0, sizeof(vy));
+    memset(vz, 0, sizeof(vz));
+    Clear();
+    nextWord = 0;
+    radius = r;
+    color = c;
+    isEnemy = enemy;
+  }
+
+  void Clear() {
+    for (auto &w : activeMask)
+      w.store(0, std::memory_order_relaxed);
+  }
+
+  bool IsActive(int i) const {
+    return (activeMask[i >> 6].load(std::memory_order_relaxed) >> (i & 63)) &
+           1u;
+  }
+
+  int LiveCount() const {
+    int n = 0;
+    for (const auto &w : activeMask)
+      n += std::popcount(w.load(std::memory_order_relaxed));
+    return n;
+  }
+
+  // Clears the slot's bit; true only for the caller that actually retired it
+  bool Deactivate(int i) {
+    uint64_t bit = 1ull << (i & 63);
+    return activeMask[i >> 6].fetch_and(~bit) & bit;
+  }
+
+  // Main thread only. The clear bits of activeMask are the free list: takes
+  // the lowest free slot of the first word, from the cursor on, that has one
+  // (at most BULLET_WORDS words). False (bullet dropped) when all are live.
+  bool Spawn(Vector3 pos, Vector3 vel) {
+    int i = -1;
+    for (int n = 0; n < BULLET_WORDS && i < 0; ++n) {
+      int w = (nextWord + n) % BULLET_WORDS;
+      uint64_t used = activeMask[w].load(std::memory_order_relaxed);
+      int slotsInWord = w == BULLET_WORDS - 1 ? MAX_BULLETS - w * 64 : 64;
+      if (slotsInWord < 64)
+        used |= ~0ull << slotsInWord;
+      if (~used) {
+        nextWord = w;
+        i = w * 64 + std::countr_zero(~used);
+      }
+    }
+    if (i < 0)
+      return false;
+    x[i] = pos.x;
+    y[i] = pos.y;
+    z[i] = pos.z;
+    vx[i] = vel.x;
+    vy[i] = vel.y;
+    vz[i] = vel.z;
+    activeMask[i >> 6].fetch_or(1ull << (i & 63));
+    return true;
+  }
+
+  Vector3 Position(int i) const { return {x[i], y[i], z[i]}; }
+  Vector3 Velocity(int i) const { return {vx[i], vy[i], vz[i]}; }
+
+  template <class F> void ForEachActive(F &&f) const {
+    for (int w = 0; w < BULLET_WORDS; ++w) {
+      uint64_t bits = activeMask[w].load(std::memory_order_relaxed);
+      while (bits) {
+        f(w * 64 + std::countr_zero(bits));
+        bits &= bits - 1;
+      }
+    }
+  }
 };
 
 struct Enemy {
   Vector3 position;
-  Vector3 lastPosition; // For stuck detection
   float speed;
-  AtomicWrapper<int> health;
+  int health;
   int maxHealth;
-  AtomicWrapper<bool> active;
+  bool active;
   int type; // 0=Basic, 1=Shooter, 2=Boss, 3=Tank, 4=Phantom, 5=Splitter,
             // 6=Support
   float shootCooldown;
   float hitTimer;     // For visual feedback
-  float stuckTimer;   // Track how long we've been stuck
   float dashTimer;    // Active dash duration
   float dashCooldown; // Cooldown between dashes
 };
@@ -187,22 +422,95 @@ struct FloatingText {
   bool active;
 };
 
+// --- Entity Pool (Dense Live List + Free List) ---
+// Fixed slots that never move (frame events refer to enemies by slot), a dense
+// list of the live slot indices so loops cost O(live) instead of O(capacity),
+// and a free list threaded through `link` so Spawn() is O(1). Spawn() returns
+// nullptr when the pool is full rather than recycling a live entry.
+// Entities still die by clearing `active` in place, which is safe inside
+// parallel batches; Sweep() then returns them to the free list. Spawn(),
+// Sweep() and Clear() are main-thread only. Range-for visits the live list.
+template <class T, int N> struct EntityPool {
+  T items[N];
+  int live[N]; // Slots in the live list, [0, count)
+  int link[N]; // Live slot: its position in live[]; free slot: next free
+  int count = 0;
+  int freeHead = -1;
+  int dropped = 0; // Spawns refused because the pool was full
+
+  void Clear() {
+    for (int i = 0; i < N; ++i) {
+      items[i].active = false;
+      link[i] = i + 1 < N ? i + 1 : -1;
+    }
+    count = 0;
+    freeHead = 0;
+  }
+
+  T *Spawn() {
+    if (freeHead < 0) {
+      dropped++;
+      return nullptr;
+    }
+    int i = freeHead;
+    freeHead = link[i];
+    link[i] = count;
+    live[count++] = i;
+    items[i] = T{};
+    items[i].active = true;
+    return &items[i];
+  }
+
+  // Frees every listed slot whose entity was deactivated since the last sweep
+  void Sweep() {
+    for (int k = count - 1; k >= 0; --k) {
+      int i = live[k];
+      if (items[i].active)
+        continue;
+      int last = live[--count];
+      live[k] = last;
+      link[last] = k;
+      link[i] = freeHead;
+      freeHead = i;
+    }
+  }
+
+  T &operator[](int slot) { return items[slot]; }
+  const T &operator[](int slot) const { return items[slot]; }
+  T &Live(int k) { return items[live[k]]; }
+
+  template <class U> struct Iterator {
+    U *items;
+    const int *slot;
+    U &operator*() const { return items[*slot]; }
+    Iterator &operator++() {
+      ++slot;
+      return *this;
+    }
+    bool operator!=(const Iterator &o) const { return slot != o.slot; }
+  };
+  Iterator<T> begin() { return {items, live}; }
+  Iterator<T> end() { return {items, live + count}; }
+  Iterator<const T> begin() const { return {items, live}; }
+  Iterator<const T> end() const { return {items, live + count}; }
+};
+
 struct GameData {
   Player player;
-  std::vector<Enemy> enemies;
-  std::vector<Bullet> playerBullets;
-  std::vector<Bullet> enemyBullets;
+  EntityPool<Enemy, MAX_ENEMIES> enemies;
+  BulletPool playerBullets;
+  BulletPool enemyBullets;
   std::vector<Obstacle> obstacles;
-  std::vector<Particle> particles;
-  std::vector<FloatingText> floatingTexts;
+  EntityPool<Particle, MAX_PARTICLES> particles;
+  EntityPool<FloatingText, MAX_FLOATING_TEXTS> floatingTexts;
 
   Camera3D camera;
   int wave;
-  AtomicWrapper<int> score;
+  int score;
   bool gameOver;
-  AtomicWrapper<int> currentScreen;  // Changed from Screen to GameScreen
-  AtomicWrapper<float> hitStopTimer; // Cinematic freeze duration
-  AtomicWrapper<float> hitShake;     // Impact screenshake intensity
+  int currentScreen;  // GameScreen
+  float hitStopTimer; // Cinematic freeze duration
+  float hitShake;     // Impact screenshake intensity
 
   float spawnTimer;
   int enemiesToSpawn;
@@ -226,75 +534,741 @@ struct GameData {
   Sound sfxEnemyShoot;
   Sound sfxEnemySpawn;
   Sound sfxBlinker;
-  int particleRollingIdx;
-  std::atomic<int> bulletRollingIdx;
-  std::atomic<int> enemyBulletRollingIdx;
 };
 
+// --- Spatial Hash Grid (Bullet Broadphase) ---
+// Uniform grid over the playfield, rebuilt every frame from the player bullet
+// pool with a counting sort. Enemies only visit the cells their threat/hit
+// radius overlaps instead of walking all MAX_BULLETS slots.
+constexpr float GRID_CELL_SIZE = 4.0f;
+constexpr float GRID_HALF_EXTENT = 100.0f; // Bullets die beyond 100 units
+constexpr int GRID_DIM = (int)(2.0f * GRID_HALF_EXTENT / GRID_CELL_SIZE);
+constexpr int GRID_CELLS = GRID_DIM * GRID_DIM;
+
+struct BulletGrid {
+  int cellStart[GRID_CELLS + 1]; // Cell c owns items [start[c], start[c+1])
+  int cellCursor[GRID_CELLS];
+  int cellItems[MAX_BULLETS];
+  int bulletCell[MAX_BULLETS];
+
+  static int CellCoord(float v) {
+    int c = (int)floorf((v + GRID_HALF_EXTENT) / GRID_CELL_SIZE);
+    return c < 0 ? 0 : (c >= GRID_DIM ? GRID_DIM - 1 : c);
+  }
+
+  void Build(const BulletPool &bullets) {
+    memset(cellStart, 0, sizeof(cellStart));
+    for (int i = 0; i < MAX_BULLETS; ++i)
+      bulletCell[i] = -1;
+    bullets.ForEachActive([&](int i) {
+      int c = CellCoord(bullets.z[i]) * GRID_DIM + CellCoord(bullets.x[i]);
+      bulletCell[i] = c;
+      cellStart[c + 1]++;
+    });
+    for (int c = 0; c < GRID_CELLS; ++c)
+      cellStart[c + 1] += cellStart[c];
+    memcpy(cellCursor, cellStart, sizeof(cellCursor));
+    for (int i = 0; i < MAX_BULLETS; ++i)
+      if (bulletCell[i] >= 0)
+        cellItems[cellCursor[bulletCell[i]]++] = i;
+  }
+
+  // Visits every bullet index in the cells overlapping the XZ square around
+  // pos. The visitor returns false to stop early. Read-only, so it is safe to
+  // call from all enemy batches at once.
+  template <class F> void Query(Vector3 pos, float radius, F &&visit) const {
+    int x0 = CellCoord(pos.x - radius), x1 = CellCoord(pos.x + radius);
+    int z0 = CellCoord(pos.z - radius), z1 = CellCoord(pos.z + radius);
+    for (int cz = z0; cz <= z1; ++cz) {
+      for (int cx = x0; cx <= x1; ++cx) {
+        int c = cz * GRID_DIM + cx;
+        for (int k = cellStart[c]; k < cellStart[c + 1]; ++k)
+          if (!visit(cellItems[k]))
+            return;
+      }
+    }
+  }
+};
+
+// --- Flow Field (Enemy Navigation) ---
+// Travel-time-to-player field over the arena, solved with the fast marching
+// method so that open ground yields straight (not 8-way) headings. The open
+// set is a bucket queue one cell wide ("untidy" FMM), which keeps the solve
+// linear in the cell count at the price of a sub-cell error in the times.
+// Cells too close to an obstacle are walls: still passable, but
+// FLOW_WALL_COST times slower, so enemies pushed into one steer back out and a
+// player hugging an obstacle stays reachable. The field is re-solved only when
+// the player enters a new cell; enemies read their heading with one lookup.
+constexpr float FLOW_CELL_SIZE = 2.0f;
+constexpr float FLOW_HALF_EXTENT = 48.0f; // Floor grid is +-40, spawns at 35
+constexpr int FLOW_DIM = (int)(2.0f * FLOW_HALF_EXTENT / FLOW_CELL_SIZE);
+constexpr int FLOW_CELLS = FLOW_DIM * FLOW_DIM;
+// Tank radius (0.8) plus half a cell diagonal: nothing standing anywhere in a
+// free cell touches an obstacle.
+constexpr float FLOW_CLEARANCE = 2.2f;
+constexpr float FLOW_WALL_COST = 20.0f;
+
+struct FlowField {
+  bool wall[FLOW_CELLS];
+  bool known[FLOW_CELLS];
+  float cost[FLOW_CELLS];
+  float dirX[FLOW_CELLS];
+  float dirZ[FLOW_CELLS];
+  int goalCell = -1; // -1 until solved, or while the player is off the grid
+  std::vector<std::vector<int>> open; // Buckets of FLOW_CELL_SIZE, reused
+
+  static bool CellOf(Vector3 p, int &cell) {
+    int x = (int)floorf((p.x + FLOW_HALF_EXTENT) / FLOW_CELL_SIZE);
+    int z = (int)floorf((p.z + FLOW_HALF_EXTENT) / FLOW_CELL_SIZE);
+    if (x < 0 || x >= FLOW_DIM || z < 0 || z >= FLOW_DIM)
+      return false;
+    cell = z * FLOW_DIM + x;
+    return true;
+  }
+
+  void BuildWalls(const std::vector<Obstacle> &obstacles) {
+    for (int c = 0; c < FLOW_CELLS; ++c) {
+      float cx = ((c % FLOW_DIM) + 0.5f) * FLOW_CELL_SIZE - FLOW_HALF_EXTENT;
+      float cz = ((c / FLOW_DIM) + 0.5f) * FLOW_CELL_SIZE - FLOW_HALF_EXTENT;
+      wall[c] = false;
+      for (const auto &obs : obstacles) {
+        if (!obs.active)
+          continue;
+        float hx = obs.size.x * 0.5f, hz = obs.size.z * 0.5f;
+        float dx = cx - fmaxf(obs.position.x - hx,
+                              fminf(cx, obs.position.x + hx));
+        float dz = cz - fmaxf(obs.position.z - hz,
+                              fminf(cz, obs.position.z + hz));
+        if (dx * dx + dz * dz < FLOW_CLEARANCE * FLOW_CLEARANCE)
+          wall[c] = true;
+      }
+    }
+    goalCell = -1;
+  }
+
+  // Re-solves the field when the target has moved to a different cell
+  void Update(Vector3 target) {
+    int cell;
+    if (!CellOf(target, cell)) {
+      goalCell = -1;
+      return;
+    }
+    if (cell == goalCell)
+      return;
+    goalCell = cell;
+    Solve();
+  }
+
+  // Heading toward the target, or fallback when pos is off the grid, shares
+  // the target's cell, or the field has no gradient there
+  Vector3 Sample(Vector3 pos, Vector3 fallback) const {
+    int cell;
+    if (goalCell < 0 || !CellOf(pos, cell) || cell == goalCell)
+      return fallback;
+    if (dirX[cell] == 0.0f && dirZ[cell] == 0.0f)
+      return fallback;
+    return {dirX[cell], 0.0f, dirZ[cell]};
+  }
+
+private:
+  float KnownCost(int x, int z) const {
+    if (x < 0 || x >= FLOW_DIM || z < 0 || z >= FLOW_DIM)
+      return INFINITY;
+    int c = z * FLOW_DIM + x;
+    return known[c] ? cost[c] : INFINITY;
+  }
+
+  // First-order upwind Eikonal update from the known axis neighbours
+  float Arrival(int c) const {
+    int x = c % FLOW_DIM, z = c / FLOW_DIM;
+    float h = wall[c] ? FLOW_CELL_SIZE * FLOW_WALL_COST : FLOW_CELL_SIZE;
+    float a = fminf(KnownCost(x - 1, z), KnownCost(x + 1, z));
+    float b = fminf(KnownCost(x, z - 1), KnownCost(x, z + 1));
+    if (a > b)
+      std::swap(a, b);
+    if (b - a >= h) // Also covers b == INFINITY
+      return a + h;
+    return 0.5f * (a + b + sqrtf(2.0f * h * h - (b - a) * (b - a)));
+  }
+
+  void Push(float t, int cell) {
+    size_t bucket = (size_t)(t / FLOW_CELL_SIZE);
+    if (bucket >= open.size())
+      open.resize(bucket + 1);
+    open[bucket].push_back(cell);
+  }
+
+  void Solve() {
+    std::fill(cost, cost + FLOW_CELLS, INFINITY);
+    std::fill(known, known + FLOW_CELLS, false);
+    for (auto &bucket : open)
+      bucket.clear();
+    cost[goalCell] = 0.0f;
+    Push(0.0f, goalCell);
+    // Index loops: Push() may grow open and the bucket being drained
+    for (size_t b = 0; b < open.size(); ++b) {
+      for (size_t i = 0; i < open[b].size(); ++i) {
+        int c = open[b][i];
+        if (known[c])
+          continue; // Stale entry, settled from a cheaper bucket
+        known[c] = true;
+        int x = c % FLOW_DIM, z = c / FLOW_DIM;
+        const int nx[4] = {x - 1, x + 1, x, x};
+        const int nz[4] = {z, z, z - 1, z + 1};
+        for (int k = 0; k < 4; ++k) {
+          if (nx[k] < 0 || nx[k] >= FLOW_DIM || nz[k] < 0 || nz[k] >= FLOW_DIM)
+            continue;
+          int n = nz[k] * FLOW_DIM + nx[k];
+          if (known[n])
+            continue;
+          float t = Arrival(n);
+          if (t < cost[n]) {
+            cost[n] = t;
+            Push(t, n);
+          }
+        }
+      }
+    }
+
+    // Heading = downhill along each axis toward the cheaper neighbour
+    for (int c = 0; c < FLOW_CELLS; ++c) {
+      int x = c % FLOW_DIM, z = c / FLOW_DIM;
+      float l = KnownCost(x - 1, z), r = KnownCost(x + 1, z);
+      float d = KnownCost(x, z - 1), u = KnownCost(x, z + 1);
+      float gx = 0.0f, gz = 0.0f;
+      if (fminf(l, r) < cost[c])
+        gx = (r < l) ? cost[c] - r : l - cost[c];
+      if (fminf(d, u) < cost[c])
+        gz = (u < d) ? cost[c] - u : d - cost[c];
+      float len = sqrtf(gx * gx + gz * gz);
+      dirX[c] = len > 0.0f ? gx / len : 0.0f;
+      dirZ[c] = len > 0.0f ? gz / len : 0.0f;
+    }
+  }
+};
+
+// --- Deterministic RNG (Counter-Based Streams) ---
+// Each value is Mix64(key + counter): no shared state beyond the stream
+// itself, so a phase can open Stream(kind, entity, frame) anywhere and get
+// the same numbers whatever thread or order it runs in. The key folds in the
+// session seed, so SeedRandom() with one seed replays a whole run. `rng` is
+// the serial gameplay stream; `fxRng` feeds particles and screen shake only.
+enum RngStreamKind : uint64_t {
+  RNG_SESSION,
+  RNG_FX,
+  RNG_AUDIO,
+  RNG_CRIT
+};
+
+static uint64_t rngSeed = 1;
+
+// SplitMix64 finalizer
+constexpr uint64_t Mix64(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+struct Rng {
+  uint64_t key = 0;
+  uint64_t counter = 0;
+
+  static Rng Stream(RngStreamKind kind, uint64_t id = 0, uint64_t frame = 0) {
+    uint64_t k = Mix64(rngSeed ^ Mix64(kind * 0x9E3779B97F4A7C15ull + id));
+    return {Mix64(k ^ (frame * 0xD1B54A32D192ED03ull)), 0};
+  }
+
+  uint64_t Next() { return Mix64(key + ++counter * 0x9E3779B97F4A7C15ull); }
+
+  // Inclusive on both ends, like GetRandomValue()
+  int Range(int min, int max) {
+    if (max < min)
+      std::swap(min, max);
+    uint64_t span = (uint64_t)((int64_t)max - min) + 1;
+    return min + (int)(((Next() >> 32) * span) >> 32);
+  }
+
+  float Float(float min, float max) {
+    return min + (max - min) * (float)(Next() >> 40) * 0x1p-24f;
+  }
+};
+
+static Rng rng;
+static Rng fxRng;
+static uint64_t simFrame = 0; // UpdateGame calls; keys per-frame streams
+
+void SeedRandom(uint64_t seed) {
+  rngSeed = seed;
+  rng = Rng::Stream(RNG_SESSION);
+  fxRng = Rng::Stream(RNG_FX);
+  simFrame = 0;
+}
+
 // --- Globals (for simple monolithic access) ---
 static GameData game; // Changed from GameState to GameData
+static BulletGrid bulletGrid; // Player bullets, rebuilt once per frame
+static FlowField flowField;   // Enemy headings toward the player
 static Shader postProcessShader;
-static std::recursive_mutex
-    gameMutex; // Protects shared game state (score, xp, spawning)
+static int firstWaveEnemies = 10; // Overridden by --entities in HEADLESS
+
+// --- Frame Profiler (make PROFILE=1) ---
+// Built with -DENABLE_PROFILER, PROFILE_ZONE("name") times its block and
+// PROFILE_PHASE("name") times the stretch up to the next mark, like the
+// HEADLESS phase marks in UpdateGame. A thread claims its own event ring on
+// its first zone and is the only writer to it, so recording never locks.
+// The rings are read on the main thread between frames, once every batch
+// has joined: F4 toggles a timeline of the last frames with one lane per
+// thread, F5 dumps all rings as Chrome Trace Event JSON (chrome://tracing,
+// Perfetto). Without the flag the PROFILE_* macros compile to nothing.
+#ifdef ENABLE_PROFILER
+#include <chrono>
+#include <cstdio>
+
+constexpr int PROFILE_MAX_THREADS = 8;  // One ring per job system thread
+constexpr int PROFILE_RING_SIZE = 4096; // Events per thread, power of 2
+constexpr int PROFILE_OVERLAY_FRAMES = 3;
+constexpr int PROFILE_MAX_DEPTH = 5; // Deeper zones are recorded, not drawn
+static const char *const PROFILE_TRACE_PATH = "profile.json";
+
+struct ProfileEvent {
+  const char *name;
+  uint64_t startNs;
+  uint64_t endNs;
+  int depth;
+};
 
-// --- Threading Infrastructure ---
-class ThreadPool {
-public:
-  ThreadPool(size_t threads) : stop(false) {
-    for (size_t i = 0; i < threads; ++i)
-      workers.emplace_back([this] {
-        for (;;) {
-          std::function<void()> task;
-          {
-            std::unique_lock<std::mutex> lock(this->queue_mutex);
-            this->condition.wait(
-                lock, [this] { return this->stop || !this->tasks.empty(); });
-            if (this->stop && this->tasks.empty())
-              return;
-            task = std::move(this->tasks.front());
-            this->tasks.pop();
-          }
-          task();
-        }
-      });
+struct ProfileRing {
+  ProfileEvent events[PROFILE_RING_SIZE];
+  std::atomic<uint64_t> head{0};
+  int depth = 1;               // Depth 0 is the frame itself
+  const char *phase = nullptr; // Open PROFILE_PHASE, if any
+  uint64_t phaseStart = 0;
+  int phaseDepth = 0;
+
+  // Owner thread only. Zones are pushed as they close, so a ring is sorted
+  // by end time and the oldest events are overwritten.
+  void Push(const char *name, uint64_t startNs, uint64_t endNs, int d) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    events[h & (PROFILE_RING_SIZE - 1)] = {name, startNs, endNs, d};
+    head.store(h + 1, std::memory_order_release);
   }
 
-  template <class F, class... Args>
-  auto enqueue(F &&f, Args &&...args)
-      -> std::future<typename std::invoke_result<F, Args...>::type> {
-    using return_type = typename std::invoke_result<F, Args...>::type;
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        std::bind(std::forward<F>(f), std::forward<Args>(args)...));
-    std::future<return_type> res = task->get_future();
-    {
-      std::unique_lock<std::mutex> lock(queue_mutex);
-      if (stop)
-        throw std::runtime_error("enqueue on stopped ThreadPool");
-      tasks.emplace([task]() { (*task)(); });
+  static uint64_t Oldest(uint64_t h) {
+    return h > PROFILE_RING_SIZE ? h - PROFILE_RING_SIZE : 0;
+  }
+
+  void ClosePhase(uint64_t now) {
+    if (!phase)
+      return;
+    depth = phaseDepth;
+    Push(phase, phaseStart, now, phaseDepth);
+    phase = nullptr;
+  }
+};
+
+struct Profiler {
+  ProfileRing rings[PROFILE_MAX_THREADS];
+  std::atomic<int> claimed{0};
+  uint64_t frameStartNs[PROFILE_OVERLAY_FRAMES + 1] = {};
+  uint64_t frameCount = 0;
+  bool showOverlay = false;
+
+  static uint64_t Now() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - epoch)
+        .count();
+  }
+
+  // The calling thread's ring, claimed on first use; nullptr when all rings
+  // are taken (that thread's zones are then skipped).
+  ProfileRing *ThreadRing() {
+    static thread_local int index = -1;
+    if (index < 0)
+      index = claimed.fetch_add(1, std::memory_order_relaxed);
+    return index < PROFILE_MAX_THREADS ? &rings[index] : nullptr;
+  }
+
+  int RingCount() const {
+    int n = claimed.load(std::memory_order_relaxed);
+    return n < PROFILE_MAX_THREADS ? n : PROFILE_MAX_THREADS;
+  }
+};
+static Profiler profiler;
+
+struct ProfileZone {
+  ProfileRing *ring;
+  const char *name;
+  uint64_t start;
+  int depth;
+
+  explicit ProfileZone(const char *zoneName)
+      : ring(profiler.ThreadRing()), name(zoneName), start(Profiler::Now()),
+        depth(ring ? ring->depth++ : 0) {}
+
+  ~ProfileZone() {
+    if (!ring)
+      return;
+    uint64_t now = Profiler::Now();
+    if (ring->phase && ring->phaseDepth > depth)
+      ring->ClosePhase(now); // Phase left open by an early return
+    ring->depth = depth;
+    ring->Push(name, start, now, depth);
+  }
+};
+
+// Ends the running phase and, unless name is nullptr, starts the next one
+void ProfilePhase(const char *name) {
+  ProfileRing *ring = profiler.ThreadRing();
+  if (!ring)
+    return;
+  uint64_t now = Profiler::Now();
+  ring->ClosePhase(now);
+  if (name) {
+    ring->phase = name;
+    ring->phaseStart = now;
+    ring->phaseDepth = ring->depth++;
+  }
+}
+
+bool ProfileWriteTrace(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (!f)
+    return false;
+  fprintf(f, "{\"traceEvents\":[");
+  bool first = true;
+  for (int t = 0; t < profiler.RingCount(); t++) {
+    const ProfileRing &ring = profiler.rings[t];
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    for (uint64_t i = ProfileRing::Oldest(head); i < head; i++) {
+      const ProfileEvent &ev = ring.events[i & (PROFILE_RING_SIZE - 1)];
+      fprintf(f,
+              "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+              "\"pid\":0,\"tid\":%d}",
+              first ? "" : ",", ev.name, ev.startNs / 1000.0,
+              (ev.endNs - ev.startNs) / 1000.0, t);
+      first = false;
     }
-    condition.notify_one();
-    return res;
   }
+  fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+  fclose(f);
+  return true;
+}
 
-  ~ThreadPool() {
-    {
-      std::unique_lock<std::mutex> lock(queue_mutex);
-      stop = true;
+// Main thread, once per rendered frame: closes the previous frame as a
+// depth-0 event and handles the hotkeys.
+void ProfileFrameMark() {
+  uint64_t now = Profiler::Now();
+  ProfileRing *ring = profiler.ThreadRing();
+  if (ring && profiler.frameCount > 0)
+    ring->Push("Frame", profiler.frameStartNs[PROFILE_OVERLAY_FRAMES], now, 0);
+  for (int i = 0; i < PROFILE_OVERLAY_FRAMES; i++)
+    profiler.frameStartNs[i] = profiler.frameStartNs[i + 1];
+  profiler.frameStartNs[PROFILE_OVERLAY_FRAMES] = now;
+  profiler.frameCount++;
+
+  if (IsKeyPressed(KEY_F4))
+    profiler.showOverlay = !profiler.showOverlay;
+  if (IsKeyPressed(KEY_F5)) {
+    bool ok = ProfileWriteTrace(PROFILE_TRACE_PATH);
+    TraceLog(ok ? LOG_INFO : LOG_WARNING, "PROFILER: %s %s",
+             ok ? "wrote" : "could not write", PROFILE_TRACE_PATH);
+  }
+}
+
+// Timeline of the last completed frames: one lane per thread, one bar row
+// per nesting depth, frame boundaries as vertical lines.
+void ProfileDrawOverlay() {
+  uint64_t begin = profiler.frameStartNs[0];
+  uint64_t end = profiler.frameStartNs[PROFILE_OVERLAY_FRAMES];
+  if (!profiler.showOverlay || begin == 0)
+    return;
+  const int rowH = 12, laneH = rowH * PROFILE_MAX_DEPTH + 4;
+  const int x0 = 20, width = SCREEN_WIDTH - 40;
+  int lanes = profiler.RingCount();
+  int y0 = SCREEN_HEIGHT - 20 - laneH * lanes;
+  float pxPerNs = (float)width / (float)(end - begin);
+
+  DrawRectangle(x0 - 6, y0 - 24, width + 12, laneH * lanes + 30,
+                Fade(BLACK, 0.75f));
+  DrawText(TextFormat("PROFILER  %i FRAMES  AVG %.2f MS",
+                      PROFILE_OVERLAY_FRAMES,
+                      (end - begin) / 1e6 / PROFILE_OVERLAY_FRAMES),
+           x0, y0 - 20, 10, LIME);
+  for (int f = 0; f <= PROFILE_OVERLAY_FRAMES; f++) {
+    int fx = x0 + (int)((profiler.frameStartNs[f] - begin) * pxPerNs);
+    DrawLine(fx, y0, fx, y0 + laneH * lanes, Fade(RED, 0.6f));
+  }
+
+  for (int t = 0; t < lanes; t++) {
+    const ProfileRing &ring = profiler.rings[t];
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    int ly = y0 + t * laneH;
+    for (uint64_t i = head; i-- > ProfileRing::Oldest(head);) {
+      const ProfileEvent &ev = ring.events[i & (PROFILE_RING_SIZE - 1)];
+      if (ev.endNs < begin)
+        break;
+      if (ev.startNs >= end || ev.depth >= PROFILE_MAX_DEPTH)
+        continue;
+      uint64_t s = ev.startNs > begin ? ev.startNs : begin;
+      uint64_t e = ev.endNs < end ? ev.endNs : end;
+      int bx = x0 + (int)((s - begin) * pxPerNs);
+      int bw = (int)((e - s) * pxPerNs);
+      if (bw < 1)
+        bw = 1;
+      int by = ly + ev.depth * rowH;
+      unsigned hash = (unsigned)((uintptr_t)ev.name * 2654435761u);
+      DrawRectangle(bx, by, bw, rowH - 1,
+                    ColorFromHSV((float)(hash % 360), 0.55f, 0.85f));
+      if (bw > 60)
+        DrawText(TextFormat("%s %.2f", ev.name, (ev.endNs - ev.startNs) / 1e6),
+                 bx + 2, by + 1, 10, BLACK);
     }
-    condition.notify_all();
+  }
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name)                                                     \
+  ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_PHASE(name) ProfilePhase(name)
+#define PROFILE_FRAME() ProfileFrameMark()
+#define PROFILE_OVERLAY() ProfileDrawOverlay()
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_PHASE(name)
+#define PROFILE_FRAME()
+#define PROFILE_OVERLAY()
+#endif
+
+// --- Threading Infrastructure: Work-Stealing Job System ---
+// Every thread (main = slot 0, workers = 1..N) owns a fixed-size Chase-Lev
+// deque: the owner pushes and pops at the bottom, idle threads steal from the
+// top. Jobs are plain structs taken from a per-thread ring, so dispatching a
+// frame's batches never allocates or takes a lock.
+constexpr int JOB_MAX_THREADS = 8;
+constexpr int JOB_QUEUE_SIZE = 256; // Power of 2; also the per-thread job ring
+#ifdef __EMSCRIPTEN__
+constexpr int JOB_WEB_WORKERS = 2; // Keep <= PTHREAD_POOL_SIZE in the Makefile
+#endif
+
+struct Job {
+  void (*fn)(const void *ctx, int begin, int end);
+  const void *ctx;
+  int begin;
+  int end;
+  std::atomic<int> *pending; // Owning ParallelFor's outstanding job count
+  const char *zone;          // Profiler label of the owning ParallelFor
+};
+
+class JobDeque {
+public:
+  // Owner only. False when full; the caller then runs the job inline.
+  bool Push(Job *job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= JOB_QUEUE_SIZE)
+      return false;
+    slots[b & (JOB_QUEUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release); // Publishes *job too
+    return true;
+  }
+
+  // Owner only. LIFO end, races thieves only for the last element.
+  Job *Pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    Job *job = slots[b & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+      if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed))
+        job = nullptr;
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+  }
+
+  // Any thread. FIFO end.
+  Job *Steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+      return nullptr;
+    Job *job = slots[t & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed))
+      return nullptr;
+    return job;
+  }
+
+private:
+  alignas(64) std::atomic<int64_t> top{0};
+  alignas(64) std::atomic<int64_t> bottom{0};
+  std::atomic<Job *> slots[JOB_QUEUE_SIZE] = {};
+};
+
+static thread_local int jobThreadIndex = 0;
+
+class JobSystem {
+public:
+  explicit JobSystem(int workerCount) {
+    if (workerCount > JOB_MAX_THREADS - 1)
+      workerCount = JOB_MAX_THREADS - 1;
+    threadCount = 1 + (workerCount > 0 ? workerCount : 0);
+    for (int i = 1; i < threadCount; ++i)
+      workers.emplace_back([this, i] { WorkerLoop(i); });
+  }
+
+  ~JobSystem() {
+    stop.store(true);
+    wakeEpoch.fetch_add(1);
+    wakeEpoch.notify_all();
     for (std::thread &worker : workers)
       worker.join();
   }
 
+  // Helper threads to start next to the main thread
+  static int DefaultWorkerCount() {
+    int hw = (int)std::thread::hardware_concurrency();
+    int count = hw > 1 ? hw - 1 : 1;
+#ifdef __EMSCRIPTEN__
+    if (count > JOB_WEB_WORKERS)
+      count = JOB_WEB_WORKERS;
+#endif
+    return count;
+  }
+
+  // Splits [begin, end) into grain-sized chunks, runs fn(chunkBegin, chunkEnd)
+  // on every thread and returns once all chunks are done. The calling thread
+  // runs the first chunk itself and then helps drain the deques. Each chunk
+  // is profiled as a `zone` on the thread that ran it.
+  template <class F>
+  void ParallelFor(int begin, int end, int grain, const F &fn,
+                   const char *zone = "Batch") {
+    if (end <= begin)
+      return;
+    if (grain < 1)
+      grain = 1;
+    int chunks = (end - begin + grain - 1) / grain;
+    if (chunks > JOB_QUEUE_SIZE) {
+      grain = (end - begin + JOB_QUEUE_SIZE - 1) / JOB_QUEUE_SIZE;
+      chunks = (end - begin + grain - 1) / grain;
+    }
+
+    int self = jobThreadIndex;
+    auto invoke = [](const void *ctx, int b, int e) {
+      (*static_cast<const F *>(ctx))(b, e);
+    };
+    std::atomic<int> pending{chunks - 1};
+    for (int c = chunks - 1; c >= 1; --c) {
+      Job *job = &jobRing[self][jobRingHead[self]++ & (JOB_QUEUE_SIZE - 1)];
+      job->fn = invoke;
+      job->ctx = &fn;
+      job->begin = begin + c * grain;
+      job->end = job->begin + grain < end ? job->begin + grain : end;
+      job->pending = &pending;
+      job->zone = zone;
+      if (!deques[self].Push(job))
+        Execute(job);
+    }
+    if (chunks > 1) {
+      wakeEpoch.fetch_add(1, std::memory_order_release);
+      wakeEpoch.notify_all();
+    }
+
+    {
+      PROFILE_ZONE(zone);
+      fn(begin, begin + grain < end ? begin + grain : end);
+    }
+    while (pending.load(std::memory_order_acquire) > 0) {
+      if (!RunOne(self))
+        std::this_thread::yield();
+    }
+  }
+
+  int ThreadCount() const { return threadCount; }
+
 private:
+  static void Execute(Job *job) {
+    {
+      PROFILE_ZONE(job->zone); // Recorded before the join can observe it
+      job->fn(job->ctx, job->begin, job->end);
+    }
+    job->pending->fetch_sub(1, std::memory_order_release);
+  }
+
+  bool RunOne(int self) {
+    Job *job = deques[self].Pop();
+    for (int i = 1; !job && i < threadCount; ++i)
+      job = deques[(self + i) % threadCount].Steal();
+    if (!job)
+      return false;
+    Execute(job);
+    return true;
+  }
+
+  void WorkerLoop(int index) {
+    jobThreadIndex = index;
+    while (!stop.load(std::memory_order_relaxed)) {
+      int epoch = wakeEpoch.load(std::memory_order_acquire);
+      bool found = false;
+      for (int spin = 0; spin < 64 && !found; ++spin)
+        found = RunOne(index);
+      // Sleep only if nothing was published since we sampled the epoch
+      if (!found)
+        wakeEpoch.wait(epoch, std::memory_order_acquire);
+    }
+  }
+
+  int threadCount = 1;
   std::vector<std::thread> workers;
-  std::queue<std::function<void()>> tasks;
-  std::mutex queue_mutex;
-  std::condition_variable condition;
-  bool stop;
+  JobDeque deques[JOB_MAX_THREADS];
+  Job jobRing[JOB_MAX_THREADS][JOB_QUEUE_SIZE];
+  unsigned jobRingHead[JOB_MAX_THREADS] = {};
+  std::atomic<bool> stop{false};
+  std::atomic<int> wakeEpoch{0};
+};
+
+static std::unique_ptr<JobSystem> jobSystem;
+
+// --- Frame Events (Two-Phase Parallel Update) ---
+// The parallel bullet and enemy batches only read shared state and write the
+// slots they own. Anything touching the player, the score, another enemy or
+// the effect queue is recorded as an event in the running thread's buffer and
+// applied by CommitFrameEvents() on the main thread, ordered by source slot,
+// so the outcome of a frame does not depend on how jobs were scheduled.
+struct FrameEvent {
+  enum Type {
+    ENEMY_CONTACT, // Enemy touched the non-dashing player
+    ENEMY_DASHED,  // Player dashed through a weak enemy
+    BULLET_HIT,    // Player bullet `bullet` overlaps the enemy
+    SUPPORT_PULSE, // Heal nearby enemies
+    ENEMY_SHOT,    // Spawn an enemy bullet at pos with velocity vec
+    PLAYER_HIT,    // Enemy bullet reached the player
+    EXPLOSION,
+    SOUND
+  };
+  Type type;
+  int source = 0; // Enemy slot, or MAX_ENEMIES + bullet slot for PLAYER_HIT
+  int bullet = -1;
+  Vector3 pos = {0, 0, 0};
+  Vector3 vec = {0, 0, 0};
+  Color color = WHITE;
+  const Sound *sfx = nullptr;
 };
 
-static std::unique_ptr<ThreadPool> threadPool;
+static std::vector<FrameEvent> frameEvents[JOB_MAX_THREADS];
+
+void EmitEvent(const FrameEvent &ev) {
+  frameEvents[jobThreadIndex].push_back(ev);
+}
 
 // --- Audio Engine ---
 enum Waveform { SINE, SQUARE, TRIANGLE, SAW, NOISE };
@@ -309,6 +1283,7 @@ Sound GenerateSynthSound(Waveform type, float freqStart, float freqEnd,
   wave.data = malloc(wave.frameCount * sizeof(short));
   short *samples = (short *)wave.data;
 
+  Rng noise = Rng::Stream(RNG_AUDIO);
   float currentPhase = 0.0f;
   for (unsigned int i = 0; i < wave.frameCount; i++) {
     float progress = (float)i / wave.frameCount;
@@ -331,7 +1306,7 @@ Sound GenerateSynthSound(Waveform type, float freqStart, float freqEnd,
           1.0f;
       break;
     case NOISE:
-      sample = (float)GetRandomValue(-100, 100) / 100.0f;
+      sample = noise.Float(-1.0f, 1.0f);
       break;
     }
 
@@ -373,8 +1348,397 @@ Sound GeneratePulseBGM(float freq) {
   return sound;
 }
 
+// --- Instanced Renderer ---
+// Bullets and particles are drawn as instances of one low-poly unit mesh.
+// DrawInstance() appends {center, size, colour} to a CPU buffer and
+// FlushInstances() uploads it and issues a single instanced draw, instead of
+// one tessellated immediate-mode DrawSphere/DrawCube per object. Without a
+// usable shader or VAO (or in HEADLESS) it falls back to the immediate call.
+constexpr int MAX_INSTANCES = 4096;
+constexpr int INSTANCE_ATTRIB_CENTER = 12; // Must match layout() in shader
+constexpr int INSTANCE_ATTRIB_COLOR = 13;
+
+#ifdef __EMSCRIPTEN__
+#define INSTANCE_GLSL_VERSION "#version 300 es\nprecision mediump float;\n"
+#else
+#define INSTANCE_GLSL_VERSION "#version 330\n"
+#endif
+
+static const char *const INSTANCE_VS = INSTANCE_GLSL_VERSION R"(
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 12) in vec4 instanceCenter; // xyz = center, w = size
+layout(location = 13) in vec4 instanceColor;
+uniform mat4 mvp;
+out vec4 fragColor;
+void main() {
+  fragColor = instanceColor;
+  vec3 world = instanceCenter.xyz + vertexPosition * instanceCenter.w;
+  gl_Position = mvp * vec4(world, 1.0);
+}
+)";
+
+static const char *const INSTANCE_FS = INSTANCE_GLSL_VERSION R"(
+in vec4 fragColor;
+out vec4 finalColor;
+void main() { finalColor = fragColor; }
+)";
+
+struct InstanceData {
+  float x, y, z, size;
+  unsigned char r, g, b, a;
+};
+
+enum InstanceShape { INSTANCE_SPHERE, INSTANCE_CUBE };
+
+struct InstanceBatch {
+  InstanceShape shape = INSTANCE_SPHERE;
+  unsigned int vao = 0;
+  unsigned int meshVbo = 0;
+  unsigned int indexVbo = 0;
+  unsigned int instanceVbo = 0;
+  int vertexCount = 0;
+  int indexCount = 0;
+  bool ready = false;
+  int count = 0;
+  InstanceData instances[MAX_INSTANCES];
+};
+
+static Shader instanceShader = {0};
+static int instanceMvpLoc = -1;
+static InstanceBatch sphereBatch; // Bullet glows and cores
+static InstanceBatch cubeBatch;   // Particles
+
+// Unit mesh: sphere of radius 1 or cube of edge 1 (DrawSphere/DrawCube sizes)
+void InitInstanceBatch(InstanceBatch &batch, InstanceShape shape,
+                       int rings = 8, int slices = 10) {
+  batch.shape = shape;
+  if (instanceShader.id == 0) {
+    instanceShader = LoadShaderFromMemory(INSTANCE_VS, INSTANCE_FS);
+    instanceMvpLoc = GetShaderLocation(instanceShader, "mvp");
+  }
+  if (instanceShader.id == rlGetShaderIdDefault())
+    return; // Compile failed
+
+  Mesh mesh = (shape == INSTANCE_SPHERE) ? GenMeshSphere(1.0f, rings, slices)
+                                         : GenMeshCube(1.0f, 1.0f, 1.0f);
+  batch.vao = rlLoadVertexArray();
+  if (batch.vao == 0) {
+    UnloadMesh(mesh);
+    return;
+  }
+  rlEnableVertexArray(batch.vao);
+  batch.vertexCount = mesh.vertexCount;
+  batch.meshVbo = rlLoadVertexBuffer(
+      mesh.vertices, mesh.vertexCount * 3 * sizeof(float), false);
+  rlSetVertexAttribute(0, 3, RL_FLOAT, false, 0, 0);
+  rlEnableVertexAttribute(0);
+  if (mesh.indices) {
+    batch.indexCount = mesh.triangleCount * 3;
+    batch.indexVbo = rlLoadVertexBufferElement(
+        mesh.indices, batch.indexCount * sizeof(unsigned short), false);
+  }
+
+  batch.instanceVbo =
+      rlLoadVertexBuffer(nullptr, sizeof(batch.instances), true);
+  rlSetVertexAttribute(INSTANCE_ATTRIB_CENTER, 4, RL_FLOAT, false,
+                       sizeof(InstanceData), 0);
+  rlEnableVertexAttribute(INSTANCE_ATTRIB_CENTER);
+  rlSetVertexAttributeDivisor(INSTANCE_ATTRIB_CENTER, 1);
+  rlSetVertexAttribute(INSTANCE_ATTRIB_COLOR, 4, RL_UNSIGNED_BYTE, true,
+                       sizeof(InstanceData), offsetof(InstanceData, r));
+  rlEnableVertexAttribute(INSTANCE_ATTRIB_COLOR);
+  rlSetVertexAttributeDivisor(INSTANCE_ATTRIB_COLOR, 1);
+  rlDisableVertexArray();
+
+  UnloadMesh(mesh);
+  batch.ready = true;
+}
+
+void UnloadInstanceBatch(InstanceBatch &batch) {
+  if (!batch.ready)
+    return;
+  rlUnloadVertexArray(batch.vao);
+  rlUnloadVertexBuffer(batch.meshVbo);
+  if (batch.indexVbo)
+    rlUnloadVertexBuffer(batch.indexVbo);
+  rlUnloadVertexBuffer(batch.instanceVbo);
+  batch.ready = false;
+}
+
+void FlushInstances(InstanceBatch &batch) {
+  if (batch.count == 0)
+    return;
+  rlDrawRenderBatchActive(); // Keep draw order with immediate-mode geometry
+
+  // Include the rlPushMatrix transform (camera shake) like DrawMesh does
+  Matrix modelView =
+      MatrixMultiply(rlGetMatrixTransform(), rlGetMatrixModelview());
+  rlEnableShader(instanceShader.id);
+  rlSetUniformMatrix(instanceMvpLoc,
+                     MatrixMultiply(modelView, rlGetMatrixProjection()));
+  rlEnableVertexArray(batch.vao);
+  rlUpdateVertexBuffer(batch.instanceVbo, batch.instances,
+                       batch.count * sizeof(InstanceData), 0);
+  if (batch.indexVbo)
+    rlDrawVertexArrayElementsInstanced(0, batch.indexCount, 0, batch.count);
+  else
+    rlDrawVertexArrayInstanced(0, batch.vertexCount, batch.count);
+  rlDisableVertexArray();
+  rlDisableShader();
+  batch.count = 0;
+}
+
+void DrawInstance(InstanceBatch &batch, Vector3 center, float size,
+                  Color color) {
+  if (!batch.ready) {
+    if (batch.shape == INSTANCE_SPHERE)
+      DrawSphere(center, size, color);
+    else
+      DrawCube(center, size, size, size, color);
+    return;
+  }
+  if (batch.count == MAX_INSTANCES)
+    FlushInstances(batch);
+  batch.instances[batch.count++] = {center.x, center.y, center.z, size,
+                                    color.r,  color.g,  color.b,  color.a};
+}
+
 static RenderTexture2D target;
 
+// --- Live Stats API (polled by the page) ---
+// game_get_stats() is exported as Module._game_get_stats and returns a
+// GameStats in the wasm heap that game_shell.html reads as 32-bit words. The
+// layout is shared with ashes.cpp and parry.cpp; keep it in sync with
+// STATS_FIELDS in the shell and wasm_loader.html, and bump STATS_VERSION on
+// change. The page polls from the browser main thread, the same thread that
+// runs UpdateDrawFrame, so it always sees a finished frame.
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+
+constexpr int STATS_VERSION = 2;
+constexpr int STATS_HISTORY = 240; // Frame times behind the percentiles
+
+struct GameStats {
+  uint32_t version;
+  uint32_t frames;
+  float frameMsP50, frameMsP95, frameMsP99, frameMsMax;
+  float simMs, drawMs; // Last frame
+  int32_t liveEnemies, liveBullets, liveParticles;
+  int32_t peakEnemies, peakBullets, peakParticles; // Session high-water marks
+  int32_t effectQueueDepth, effectQueuePeak; // Commands drained last frame
+  int32_t qualityTier;                       // Index into QUALITY_TIERS
+};
+
+struct StatsRecorder {
+  GameStats out = {};
+  float frameMs[STATS_HISTORY] = {};
+  double frameStart = 0.0;
+  double markTime = 0.0;
+};
+static StatsRecorder stats;
+
+// Top of each rendered frame: closes the previous frame's wall time
+void StatsBeginFrame() {
+  double now = GetTime();
+  if (stats.frameStart > 0.0) {
+    stats.frameMs[stats.out.frames % STATS_HISTORY] =
+        (float)((now - stats.frameStart) * 1000.0);
+    stats.out.frames++;
+  }
+  stats.frameStart = stats.markTime = now;
+}
+
+// Milliseconds since the last begin/lap
+float StatsLap() {
+  double now = GetTime();
+  float ms = (float)((now - stats.markTime) * 1000.0);
+  stats.markTime = now;
+  return ms;
+}
+
+void StatsEndSim() { stats.out.simMs = StatsLap(); }
+
+void StatsEndDraw() {
+  GameStats &s = stats.out;
+  s.drawMs = StatsLap();
+  s.liveEnemies = game.enemies.count;
+  s.liveBullets =
+      game.playerBullets.LiveCount() + game.enemyBullets.LiveCount();
+  s.liveParticles = game.particles.count;
+  s.peakEnemies = std::max(s.peakEnemies, s.liveEnemies);
+  s.peakBullets = std::max(s.peakBullets, s.liveBullets);
+  s.peakParticles = std::max(s.peakParticles, s.liveParticles);
+}
+
+// Called by ProcessEffectBuffer() before it drains the queue
+void StatsSampleEffectQueue(int depth) {
+  stats.out.effectQueueDepth = depth;
+  stats.out.effectQueuePeak = std::max(stats.out.effectQueuePeak, depth);
+}
+
+// --- Quality Governor ---
+// Picks a visual tier from the measured wall frame time so slow machines lose
+// particles, bullet trails, sphere facets, render resolution and the CRT pass
+// instead of sim time. The mean over a rolling window drops a tier as soon as
+// it crosses QUALITY_DEGRADE_MS; climbing back needs upgradeHold seconds below
+// the lower QUALITY_UPGRADE_MS, and an upgrade reverted within
+// QUALITY_REVERT_WINDOW doubles that hold. Tier changes happen between frames
+// on the main thread, so workers never see one mid-update. HEADLESS never
+// feeds the governor.
+struct QualityTier {
+  const char *name;
+  float particleScale;  // Particles per queued explosion (20 on HIGH)
+  float bulletTrail;    // Trail line length in units, 0 = no trail
+  int sphereRings;      // Instanced bullet sphere mesh
+  int sphereSlices;
+  bool postProcess;     // CRT shader pass
+  float maxRenderScale; // Ceiling for the dynamic resolution controller
+};
+
+constexpr QualityTier QUALITY_TIERS[] = {
+    {"HIGH", 1.00f, 1.0f, 8, 10, true, 1.00f},
+    {"MEDIUM", 0.60f, 0.6f, 6, 8, true, 0.85f},
+    {"LOW", 0.30f, 0.0f, 4, 6, false, 0.70f},
+};
+constexpr int QUALITY_TIER_COUNT =
+    sizeof(QUALITY_TIERS) / sizeof(QUALITY_TIERS[0]);
+constexpr int QUALITY_WINDOW = 90;             // Frames in the rolling mean
+constexpr float QUALITY_DEGRADE_MS = 19.0f;    // ~52 fps
+constexpr float QUALITY_UPGRADE_MS = 17.5f;    // ~57 fps
+constexpr float QUALITY_SAMPLE_CAP_MS = 100.0f; // Limits one hitch's weight
+constexpr float QUALITY_UPGRADE_HOLD = 4.0f;
+constexpr float QUALITY_UPGRADE_HOLD_MAX = 64.0f;
+constexpr float QUALITY_REVERT_WINDOW = 10.0f;
+
+struct QualityGovernor {
+  float samples[QUALITY_WINDOW] = {};
+  float sum = 0.0f;
+  int count = 0;
+  int head = 0;
+  int tier = 0;
+  float calm = 0.0f; // Seconds the mean has stayed under QUALITY_UPGRADE_MS
+  float sinceChange = 0.0f;
+  bool lastWasUpgrade = false;
+  float upgradeHold = QUALITY_UPGRADE_HOLD;
+};
+static QualityGovernor quality;
+
+const QualityTier &Quality() { return QUALITY_TIERS[quality.tier]; }
+
+int QualityParticles(int count) {
+  return std::max(1, (int)(count * Quality().particleScale + 0.5f));
+}
+
+void QualitySetTier(int tier) {
+  quality.lastWasUpgrade = tier < quality.tier;
+  quality.tier = tier;
+  quality.count = quality.head = 0; // The new tier is judged on its own frames
+  quality.sum = quality.calm = quality.sinceChange = 0.0f;
+  if (sphereBatch.ready) { // Retessellate the instanced sphere
+    UnloadInstanceBatch(sphereBatch);
+    InitInstanceBatch(sphereBatch, INSTANCE_SPHERE, Quality().sphereRings,
+                      Quality().sphereSlices);
+  }
+  TraceLog(LOG_INFO, "Quality tier: %s", Quality().name);
+}
+
+void QualityObserve(float frameMs) {
+  float ms = std::min(frameMs, QUALITY_SAMPLE_CAP_MS);
+  if (quality.count == QUALITY_WINDOW)
+    quality.sum -= quality.samples[quality.head];
+  else
+    quality.count++;
+  quality.samples[quality.head] = ms;
+  quality.sum += ms;
+  quality.head = (quality.head + 1) % QUALITY_WINDOW;
+  quality.sinceChange += ms / 1000.0f;
+  if (quality.count < QUALITY_WINDOW)
+    return;
+
+  float mean = quality.sum / quality.count;
+  if (mean > QUALITY_DEGRADE_MS) {
+    if (quality.tier == QUALITY_TIER_COUNT - 1)
+      return;
+    if (quality.lastWasUpgrade && quality.sinceChange < QUALITY_REVERT_WINDOW)
+      quality.upgradeHold =
+          std::min(quality.upgradeHold * 2.0f, QUALITY_UPGRADE_HOLD_MAX);
+    QualitySetTier(quality.tier + 1);
+  } else if (mean < QUALITY_UPGRADE_MS && quality.tier > 0) {
+    quality.calm += ms / 1000.0f;
+    if (quality.calm >= quality.upgradeHold)
+      QualitySetTier(quality.tier - 1);
+  } else {
+    quality.calm = 0.0f;
+  }
+}
+
+extern "C" EMSCRIPTEN_KEEPALIVE const GameStats *game_get_stats() {
+  int n = std::min<int>(stats.out.frames, STATS_HISTORY);
+  float sorted[STATS_HISTORY];
+  std::copy(stats.frameMs, stats.frameMs + n, sorted);
+  std::sort(sorted, sorted + n);
+  auto pct = [&](float p) {
+    return n ? sorted[std::min(n - 1, (int)(p * n))] : 0.0f;
+  };
+  stats.out.version = STATS_VERSION;
+  stats.out.frameMsP50 = pct(0.50f);
+  stats.out.frameMsP95 = pct(0.95f);
+  stats.out.frameMsP99 = pct(0.99f);
+  stats.out.frameMsMax = n ? sorted[n - 1] : 0.0f;
+  stats.out.qualityTier = quality.tier;
+  return &stats.out;
+}
+
+// --- Dynamic Resolution ---
+// The 3D scene is drawn into the bottom-left scale x scale corner of the
+// full-size `target` and the CRT pass stretches that corner back over the
+// screen, so scene fill cost follows scale^2 while the HUD (drawn after the
+// pass) stays native. Only the viewport changes; the texture is allocated
+// once, so moving the scale never reallocates a framebuffer. BeginTextureMode
+// sets up projections for the full texture, so the 3D camera and the 2D
+// screens inside the target land in the smaller viewport unchanged.
+//
+// The controller follows a smoothed wall frame time: it sheds resolution
+// quickly above DYNRES_SHRINK_MS and wins it back slowly below
+// DYNRES_GROW_MS, between DYNRES_MIN_SCALE and the quality tier's ceiling.
+// It reacts before the quality governor (19 ms) does, so fill-bound machines
+// lose pixels first and effects only if that is not enough.
+constexpr float DYNRES_MIN_SCALE = 0.5f;
+constexpr float DYNRES_SHRINK_MS = 18.0f;
+constexpr float DYNRES_GROW_MS = 17.2f;
+constexpr float DYNRES_SHRINK_RATE = 0.5f; // Scale lost per second
+constexpr float DYNRES_GROW_RATE = 0.05f;  // Scale regained per second
+constexpr float DYNRES_SMOOTHING = 0.1f;   // EMA weight of the newest frame
+
+struct DynamicResolution {
+  bool enabled = true; // Debug key 9; off pins the scale to the tier ceiling
+  float scale = 1.0f;
+  float smoothedMs = 1000.0f / 60.0f;
+};
+static DynamicResolution dynRes;
+
+void DynResUpdate(float frameMs) {
+  float ceiling = Quality().maxRenderScale;
+  if (!dynRes.enabled) {
+    dynRes.scale = ceiling;
+    return;
+  }
+  dynRes.smoothedMs += (frameMs - dynRes.smoothedMs) * DYNRES_SMOOTHING;
+  float dt = std::min(frameMs, QUALITY_SAMPLE_CAP_MS) / 1000.0f;
+  if (dynRes.smoothedMs > DYNRES_SHRINK_MS)
+    dynRes.scale -= DYNRES_SHRINK_RATE * dt;
+  else if (dynRes.smoothedMs < DYNRES_GROW_MS)
+    dynRes.scale += DYNRES_GROW_RATE * dt;
+  dynRes.scale = Clamp(dynRes.scale, DYNRES_MIN_SCALE, ceiling);
+}
+
+// Scene viewport inside `target`, in pixels (even, so the upscale is stable)
+int DynResWidth() { return (int)(SCREEN_WIDTH * dynRes.scale) & ~1; }
+int DynResHeight() { return (int)(SCREEN_HEIGHT * dynRes.scale) & ~1; }
+
 // --- Forward Declarations ---
 void InitGame();
 void UpdateGame();
@@ -385,6 +1749,7 @@ void SpawnFloatingText(Vector3 pos, const char *text, Color color);
 void CheckLevelUp();
 Sound GenerateBeep(float frequency, float duration);
 
+#ifndef HEADLESS
 int main() {
   InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Cursor - Ascend the Code");
   SetTargetFPS(60);
@@ -395,12 +1760,18 @@ int main() {
 
   // Create Render Texture
   target = LoadRenderTexture(SCREEN_WIDTH, SCREEN_HEIGHT);
+  SetTextureFilter(target.texture, TEXTURE_FILTER_BILINEAR); // Upscaled
+
+  // Instanced bullets and particles (needs the GL context)
+  InitInstanceBatch(sphereBatch, INSTANCE_SPHERE);
+  InitInstanceBatch(cubeBatch, INSTANCE_CUBE);
 
-  // Initialize Thread Pool
-  threadPool =
-      std::make_unique<ThreadPool>(std::thread::hardware_concurrency());
+  // Initialize Job System
+  jobSystem = std::make_unique<JobSystem>(JobSystem::DefaultWorkerCount());
 
   InitAudioDevice();
+  SeedRandom((uint64_t)time(nullptr));
+  TraceLog(LOG_INFO, "RNG seed: %llu", (unsigned long long)rngSeed);
   InitGame();
 
   // Generate Procedural SFX (The "Programmer Sound" Overhaul)
@@ -423,33 +1794,39 @@ int main() {
   game.sfxBonus = GeneratePulseBGM(60.0f);
 
   while (!WindowShouldClose()) {
-    // Update Shader Uniforms
-    float time = (float)GetTime();
-    Vector2 res = {(float)SCREEN_WIDTH, (float)SCREEN_HEIGHT};
-    SetShaderValue(postProcessShader,
-                   GetShaderLocation(postProcessShader, "time"), &time,
-                   SHADER_UNIFORM_FLOAT);
-    SetShaderValue(postProcessShader,
-                   GetShaderLocation(postProcessShader, "resolution"), &res,
-                   SHADER_UNIFORM_VEC2);
-
-    float aberration = 0.001f;
-    if (game.hitStopTimer > 0)
-      aberration = 0.005f;
-    SetShaderValue(postProcessShader,
-                   GetShaderLocation(postProcessShader, "aberration"),
-                   &aberration, SHADER_UNIFORM_FLOAT);
+    // Update Shader Uniforms (skipped while the tier has the CRT pass off)
+    if (Quality().postProcess) {
+      float time = (float)GetTime();
+      Vector2 res = {(float)SCREEN_WIDTH, (float)SCREEN_HEIGHT};
+      SetShaderValue(postProcessShader,
+                     GetShaderLocation(postProcessShader, "time"), &time,
+                     SHADER_UNIFORM_FLOAT);
+      SetShaderValue(postProcessShader,
+                     GetShaderLocation(postProcessShader, "resolution"), &res,
+                     SHADER_UNIFORM_VEC2);
+
+      float aberration = 0.001f;
+      if (game.hitStopTimer > 0)
+        aberration = 0.005f;
+      SetShaderValue(postProcessShader,
+                     GetShaderLocation(postProcessShader, "aberration"),
+                     &aberration, SHADER_UNIFORM_FLOAT);
+    }
 
     UpdateDrawFrame();
   }
 
   // Cleanup
+  UnloadInstanceBatch(sphereBatch);
+  UnloadInstanceBatch(cubeBatch);
+  UnloadShader(instanceShader);
   UnloadShader(postProcessShader);
   UnloadRenderTexture(target);
   CloseAudioDevice();
   CloseWindow();
   return 0;
 }
+#endif
 
 // SFX Generation Helper replaced by GenerateSynthSound
 
@@ -460,7 +1837,6 @@ void SpawnFloatingText(Vector3 pos, const char *text, Color color) {
 
 // Helper: Centralized Level Up Logic
 void CheckLevelUp() {
-  std::lock_guard<std::recursive_mutex> lock(gameMutex);
   while (game.player.xp >= game.player.xpToNextLevel) {
     game.player.xp -= game.player.xpToNextLevel;
     game.player.level++;
@@ -511,44 +1887,16 @@ void InitGame() {
 
   // --- Wave System ---
   game.currentScreen = SCREEN_MENU;
-  game.enemiesToSpawn = 10;
+  game.enemiesToSpawn = firstWaveEnemies;
   game.enemiesSpawned = 0;
   game.spawnTimer = 2.0f;
 
   // Initialize Vectors with pre-allocation
-  game.playerBullets.assign(MAX_BULLETS,
-                            {{0, 0, 0}, {0, 0, 0}, 0.1f, false, WHITE, false});
-  game.enemyBullets.assign(MAX_BULLETS,
-                           {{0, 0, 0}, {0, 0, 0}, 0.1f, false, RED, true});
-  game.enemies.assign(MAX_ENEMIES, {{0, 0, 0},
-                                    {0, 0, 0},
-                                    2.0f,
-                                    0,
-                                    0,
-                                    false,
-                                    0,
-                                    0.0f,
-                                    0.0f,
-                                    0.0f,
-                                    0.0f,
-                                    0.0f});
-  game.particles.assign(MAX_PARTICLES,
-                        {{0, 0, 0}, {0, 0, 0}, WHITE, 0.1f, 0.0f, 1.0f, false});
-  game.floatingTexts.assign(MAX_FLOATING_TEXTS,
-                            {{0, 0, 0}, "", WHITE, 0.0f, 0.0f, false});
-  game.particleRollingIdx = 0;
-
-  // Ensure all entities are deactivated at start
-  for (auto &b : game.playerBullets)
-    b.active = false;
-  for (auto &b : game.enemyBullets)
-    b.active = false;
-  for (auto &e : game.enemies)
-    e.active = false;
-  for (auto &p : game.particles)
-    p.active = false;
-  for (auto &ft : game.floatingTexts)
-    ft.active = false;
+  game.playerBullets.Reset(PLAYER_BULLET_RADIUS, SKYBLUE, false);
+  game.enemyBullets.Reset(ENEMY_BULLET_RADIUS, RED, true);
+  game.enemies.Clear();
+  game.particles.Clear();
+  game.floatingTexts.Clear();
 
   // Initialize Obstacles
   game.obstacles.clear();
@@ -568,6 +1916,7 @@ void InitGame() {
     obs.active = true;
     game.obstacles.push_back(obs);
   }
+  flowField.BuildWalls(game.obstacles);
 
   // Initialize Camera
   game.camera.position = {0.0f, 20.0f, 10.0f}; // Top-down angled
@@ -577,41 +1926,65 @@ void InitGame() {
   game.camera.projection = CAMERA_PERSPECTIVE;
 }
 
-// Helper: Check Bullet collision with obstacles
-bool CheckBulletObstacles(Vector3 pos, float radius) {
+// Bullet Kernel: integrates one SIMD block starting at slot `base` and
+// returns a lane mask of bullets that left the arena or hit an obstacle
+// (sphere-box test against every obstacle, same as the old scalar check).
+unsigned IntegrateBulletBlock(BulletPool &pool, int base, float dt) {
+  vfloat vdt = VSet(dt);
+  vfloat px = VAdd(VLoad(pool.x + base), VMul(VLoad(pool.vx + base), vdt));
+  vfloat py = VAdd(VLoad(pool.y + base), VMul(VLoad(pool.vy + base), vdt));
+  vfloat pz = VAdd(VLoad(pool.z + base), VMul(VLoad(pool.vz + base), vdt));
+  VStore(pool.x + base, px);
+  VStore(pool.y + base, py);
+  VStore(pool.z + base, pz);
+
+  vfloat len2 = VAdd(VAdd(VMul(px, px), VMul(py, py)), VMul(pz, pz));
+  unsigned kill = VMaskLess(VSet(BULLET_MAX_DIST * BULLET_MAX_DIST), len2);
+
+  vfloat r2 = VSet(pool.radius * pool.radius);
   for (const auto &obs : game.obstacles) {
-    // Simple sphere-box check
-    Vector3 clamp = Vector3Max(
-        Vector3Subtract(obs.position, Vector3Scale(obs.size, 0.5f)),
-        Vector3Min(Vector3Add(obs.position, Vector3Scale(obs.size, 0.5f)),
-                   pos));
-    float dist = Vector3Distance(pos, clamp);
-    if (dist < radius)
-      return true;
+    Vector3 lo = Vector3Subtract(obs.position, Vector3Scale(obs.size, 0.5f));
+    Vector3 hi = Vector3Add(obs.position, Vector3Scale(obs.size, 0.5f));
+    vfloat dx = VSub(px, VMax(VSet(lo.x), VMin(VSet(hi.x), px)));
+    vfloat dy = VSub(py, VMax(VSet(lo.y), VMin(VSet(hi.y), py)));
+    vfloat dz = VSub(pz, VMax(VSet(lo.z), VMin(VSet(hi.z), pz)));
+    vfloat d2 = VAdd(VAdd(VMul(dx, dx), VMul(dy, dy)), VMul(dz, dz));
+    kill |= VMaskLess(d2, r2);
+  }
+  return kill;
+}
+
+// Runs the kernel over mask words [wordBegin, wordEnd), skipping empty words
+// and empty blocks, and retires the bullets it flags. Returns the surviving
+// active bits of each block through onSurvivors(base, laneMask).
+template <class F>
+void UpdateBulletWords(BulletPool &pool, int wordBegin, int wordEnd, float dt,
+                       F &&onSurvivors) {
+  for (int w = wordBegin; w < wordEnd; ++w) {
+    uint64_t bits = pool.activeMask[w].load(std::memory_order_relaxed);
+    if (!bits)
+      continue;
+    uint64_t retired = 0;
+    for (int lane = 0; lane < 64; lane += SIMD_LANES) {
+      unsigned live = (unsigned)(bits >> lane) & SIMD_LANE_MASK;
+      if (!live)
+        continue;
+      unsigned kill = IntegrateBulletBlock(pool, w * 64 + lane, dt) & live;
+      retired |= (uint64_t)kill << lane;
+      if (live & ~kill)
+        onSurvivors(w * 64 + lane, live & ~kill);
+    }
+    if (retired)
+      pool.activeMask[w].fetch_and(~retired);
   }
-  return false;
 }
 
 void SpawnBullet(Vector3 pos, Vector3 vel) {
-  int idx = game.bulletRollingIdx.fetch_add(1) % MAX_BULLETS;
-  auto &b = game.playerBullets[idx];
-  b.active = true;
-  b.position = pos;
-  b.velocity = vel;
-  b.radius = 0.2f;
-  b.color = SKYBLUE;
-  b.isEnemyBullet = false;
+  game.playerBullets.Spawn(pos, vel);
 }
 
 void SpawnEnemyBullet(Vector3 pos, Vector3 vel) {
-  int idx = game.enemyBulletRollingIdx.fetch_add(1) % MAX_BULLETS;
-  auto &b = game.enemyBullets[idx];
-  b.active = true;
-  b.position = pos;
-  b.velocity = vel;
-  b.radius = 0.25f;
-  b.color = RED;
-  b.isEnemyBullet = true;
+  game.enemyBullets.Spawn(pos, vel);
 }
 
 // Helper: Check entity collision with obstacles
@@ -633,88 +2006,177 @@ bool CheckEntityObstacleCollision(Vector3 pos, float radius) {
 }
 
 // Helper: Check if bullet threatens entity
-bool BulletThreatsEntity(const Bullet &b, Vector3 entityPos,
+bool BulletThreatsEntity(const BulletPool &pool, int i, Vector3 entityPos,
                          float threatRange) {
-  if (!b.active)
+  if (!pool.IsActive(i))
     return false;
-  float distToBullet = Vector3Distance(b.position, entityPos);
+  Vector3 bulletPos = pool.Position(i);
+  float distToBullet = Vector3Distance(bulletPos, entityPos);
   if (distToBullet > threatRange)
     return false;
-  Vector3 toBullet = Vector3Subtract(b.position, entityPos);
-  float dotProduct = Vector3DotProduct(Vector3Normalize(b.velocity),
+  Vector3 toBullet = Vector3Subtract(bulletPos, entityPos);
+  float dotProduct = Vector3DotProduct(Vector3Normalize(pool.Velocity(i)),
                                        Vector3Normalize(toBullet));
   return dotProduct < -0.3f;
 }
 
-// Helper: Get obstacle avoidance direction (improved)
-Vector3 GetAvoidanceDirection(Vector3 pos, Vector3 forward, float lookAhead) {
-  // First check if we're already stuck in an obstacle
-  if (CheckEntityObstacleCollision(pos, 0.5f)) {
-    // Already stuck! Try to escape in any clear direction
-    Vector3 escapeDirections[] = {{1, 0, 0},
-                                  {-1, 0, 0},
-                                  {0, 0, 1},
-                                  {0, 0, -1},
-                                  {0.707f, 0, 0.707f},
-                                  {-0.707f, 0, 0.707f},
-                                  {0.707f, 0, -0.707f},
-                                  {-0.707f, 0, -0.707f}};
-
-    for (int i = 0; i < 8; i++) {
-      Vector3 testPos =
-          Vector3Add(pos, Vector3Scale(escapeDirections[i], 1.0f));
-      if (!CheckEntityObstacleCollision(testPos, 0.5f)) {
-        return escapeDirections[i]; // Found escape route
+// Enemy death: rewards, effects and the splitter's offspring
+void KillEnemy(Enemy &e) {
+  e.active = false;
+  game.hitStopTimer = fmaxf(game.hitStopTimer, 0.12f);
+  game.hitShake = fmaxf(game.hitShake, 0.5f);
+  QueueSound(game.sfxExplosion);
+  Color ec = (e.type == 2)   ? PURPLE
+             : (e.type == 3) ? DARKGREEN
+             : (e.type == 1) ? MAROON
+             : (e.type == 4) ? MAGENTA
+             : (e.type == 5) ? LIME
+             : (e.type == 6) ? SKYBLUE
+                             : RED;
+  QueueExplosion(e.position, ec);
+
+  if (e.type == 5) {
+    for (int i = 0; i < 3; ++i) {
+      Enemy *bit = game.enemies.Spawn();
+      if (!bit)
+        break;
+      bit->type = 0;
+      bit->maxHealth = 40;
+      bit->health = 40;
+      bit->speed = 8.0f;
+      bit->position = Vector3Add(e.position, {(float)rng.Range(-1, 1), 0,
+                                              (float)rng.Range(-1, 1)});
+    }
+  }
+  game.player.xp += (e.type == 2 ? 500 : (e.type == 3 ? 100 : 25));
+  game.score += (e.type == 2 ? 1000 : (e.type == 3 ? 150 : 50));
+}
+
+// Applies the events recorded by this frame's parallel phases, merged by
+// source slot; events from one source keep the order they were emitted in.
+void CommitFrameEvents() {
+  PROFILE_ZONE("CommitFrameEvents");
+  static std::vector<FrameEvent> merged;
+  merged.clear();
+  for (auto &buffer : frameEvents) {
+    merged.insert(merged.end(), buffer.begin(), buffer.end());
+    buffer.clear();
+  }
+  std::stable_sort(merged.begin(), merged.end(),
+                   [](const FrameEvent &a, const FrameEvent &b) {
+                     return a.source < b.source;
+                   });
+
+  int lastShotEnemy = -1; // An enemy takes at most one bullet per frame
+  for (const FrameEvent &ev : merged) {
+    Enemy *e = ev.source < MAX_ENEMIES ? &game.enemies[ev.source] : nullptr;
+    switch (ev.type) {
+    case FrameEvent::ENEMY_CONTACT: {
+      if (!e->active)
+        break;
+      game.player.health -= 10;
+      e->health -= 50; // Damage the enemy too
+      e->hitTimer = 0.2f;
+      game.hitShake = fmaxf(game.hitShake, 0.5f);
+      QueueSound(game.sfxHit);
+      QueueExplosion(e->position, ORANGE);
+
+      // Knockback
+      Vector3 kb = Vector3Normalize(
+          Vector3Subtract(game.player.position, e->position));
+      game.player.position = Vector3Add(game.player.position, kb);
+      e->position = Vector3Subtract(e->position, kb);
+
+      if (e->health <= 0 && e->type != 2) {
+        e->active = false;
+        game.player.xp += (e->type == 3 ? 100 : 25);
+        game.score += (e->type == 3 ? 150 : 50);
+        QueueSound(game.sfxExplosion);
       }
+      if (game.player.health <= 0)
+        game.currentScreen = (int)SCREEN_GAMEOVER;
+      break;
     }
-    return Vector3Negate(forward); // Last resort: back up
-  }
-
-  // Check multiple distances ahead
-  Vector3 normForward = Vector3Normalize(forward);
-  for (float dist = lookAhead; dist >= 1.0f; dist -= 0.5f) {
-    Vector3 testPos = Vector3Add(pos, Vector3Scale(normForward, dist));
-    if (CheckEntityObstacleCollision(testPos, 0.5f)) {
-      // Obstacle detected! Find best tangent
-      Vector3 right = {normForward.z, 0, -normForward.x};
-      Vector3 left = Vector3Negate(right);
-
-      // Test both tangents
-      Vector3 testRight = Vector3Add(pos, Vector3Scale(right, lookAhead));
-      Vector3 testLeft = Vector3Add(pos, Vector3Scale(left, lookAhead));
-
-      bool rightClear = !CheckEntityObstacleCollision(testRight, 0.5f);
-      bool leftClear = !CheckEntityObstacleCollision(testLeft, 0.5f);
-
-      if (rightClear && !leftClear)
-        return right;
-      if (leftClear && !rightClear)
-        return left;
-      if (rightClear && leftClear) {
-        // Both clear, pick randomly
-        return GetRandomValue(0, 1) ? right : left;
+    case FrameEvent::ENEMY_DASHED:
+      if (!e->active)
+        break;
+      game.player.xp += (e->type == 3 ? 100 : 25);
+      game.score += (e->type == 3 ? 150 : 50);
+      e->active = false;
+      QueueSound(game.sfxExplosion);
+      QueueExplosion(e->position, ORANGE);
+      break;
+    case FrameEvent::BULLET_HIT: {
+      // Candidates arrive in grid order; the first bullet still alive wins
+      if (!e->active || ev.source == lastShotEnemy ||
+          !game.playerBullets.Deactivate(ev.bullet))
+        break;
+      lastShotEnemy = ev.source;
+
+      float damage = 20.0f * game.player.damageMult;
+      bool isCrit = false;
+      // Keyed by enemy and frame, so event order cannot change who crits
+      Rng crit = Rng::Stream(RNG_CRIT, ev.source, simFrame);
+      if (crit.Float(0.0f, 1.0f) < game.player.critChance) {
+        damage *= 2.0f;
+        isCrit = true;
       }
-
-      // Both blocked, try diagonal
-      Vector3 diagRight = Vector3Normalize(Vector3Add(normForward, right));
-      Vector3 diagLeft = Vector3Normalize(Vector3Add(normForward, left));
-      Vector3 testDiagRight =
-          Vector3Add(pos, Vector3Scale(diagRight, lookAhead));
-      Vector3 testDiagLeft = Vector3Add(pos, Vector3Scale(diagLeft, lookAhead));
-
-      if (!CheckEntityObstacleCollision(testDiagRight, 0.5f))
-        return diagRight;
-      if (!CheckEntityObstacleCollision(testDiagLeft, 0.5f))
-        return diagLeft;
-
-      return Vector3Negate(normForward); // Blocked ahead, reverse
+      e->health -= (int)damage;
+      e->hitTimer = 0.1f;
+      QueueExplosion(ev.pos, WHITE);
+
+      float knockbackValue =
+          (e->type == 2) ? 0.1f : (e->type == 3 ? 0.2f : 0.5f);
+      e->position =
+          Vector3Add(e->position, Vector3Scale(ev.vec, knockbackValue));
+
+      float stop = isCrit ? 0.08f : 0.05f;
+      game.hitStopTimer = fmaxf(game.hitStopTimer, stop);
+      game.hitShake = fmaxf(game.hitShake, isCrit ? 0.3f : 0.15f);
+      if (isCrit)
+        QueueText(e->position, TextFormat("%d CRIT!", (int)damage), GOLD);
+      else
+        QueueText(e->position, TextFormat("%d", (int)damage), WHITE);
+
+      if (e->health <= 0)
+        KillEnemy(*e);
+      break;
+    }
+    case FrameEvent::SUPPORT_PULSE:
+      if (!e->active)
+        break;
+      QueueExplosion(e->position, SKYBLUE);
+      for (auto &other : game.enemies) {
+        if (other.active &&
+            Vector3DistanceSqr(e->position, other.position) < 64.0f) {
+          other.health += 10;
+          if (other.health > other.maxHealth)
+            other.health = other.maxHealth;
+        }
+      }
+      break;
+    case FrameEvent::ENEMY_SHOT:
+      SpawnEnemyBullet(ev.pos, ev.vec);
+      break;
+    case FrameEvent::PLAYER_HIT:
+      game.player.health -= 5;
+      QueueExplosion(game.player.position, RED);
+      if (game.player.health <= 0)
+        game.currentScreen = (int)SCREEN_GAMEOVER;
+      break;
+    case FrameEvent::EXPLOSION:
+      QueueExplosion(ev.pos, ev.color);
+      break;
+    case FrameEvent::SOUND:
+      QueueSound(*ev.sfx);
+      break;
     }
   }
-
-  return normForward; // Path clear
 }
 
 void UpdateGame() {
+  PROFILE_ZONE("UpdateGame");
+  simFrame++;
   if (game.currentScreen == SCREEN_MENU) {
     if (IsKeyPressed(KEY_SPACE)) {
       game.currentScreen = SCREEN_PLAYING;
@@ -722,15 +2184,12 @@ void UpdateGame() {
       game.wave = 1;
       game.score = 0;
       game.player.health = game.player.maxHealth;
-      game.enemiesToSpawn = 10;
+      game.enemiesToSpawn = firstWaveEnemies;
       game.enemiesSpawned = 0;
       // Clear enemies and bullets
-      for (auto &e : game.enemies)
-        e.active = false;
-      for (auto &b : game.playerBullets)
-        b.active = false;
-      for (auto &b : game.enemyBullets)
-        b.active = false;
+      game.enemies.Clear();
+      game.playerBullets.Clear();
+      game.enemyBullets.Clear();
     }
     return;
   } else if (game.currentScreen == SCREEN_GAMEOVER) {
@@ -758,6 +2217,7 @@ void UpdateGame() {
     return;
   }
 
+  PROFILE_PHASE("UpdatePlayer");
   // --- Wave Logic ---
   bool allDead = true;
   for (const auto &e : game.enemies) {
@@ -795,38 +2255,36 @@ void UpdateGame() {
       spawnType = 2;
     else if (IsKeyPressed(KEY_FOUR))
       spawnType = 3;
+    if (IsKeyPressed(KEY_NINE))
+      dynRes.enabled = !dynRes.enabled;
 
     if (spawnType != -1) {
-      for (auto &e : game.enemies) {
-        if (!e.active) {
-          e.active = true;
-          e.type = spawnType;
-          e.hitTimer = 0.0f;
-
-          // Stats
-          if (e.type == 2) { // Boss
-            e.maxHealth = 200;
-            e.shootCooldown = 0.5f;
-            e.position = {0, 1, -20};
-          } else if (e.type == 3) { // Tank
-            e.maxHealth = 20;
-            e.shootCooldown = 0;
-            e.position = Vector3Add(game.player.position, {10, 0, 10});
-          } else if (e.type == 1) { // Shooter
-            e.maxHealth = 5;
-            e.shootCooldown = 2.0f;
-            e.position = Vector3Add(game.player.position, {-10, 0, -10});
-          } else { // Chaser
-            e.maxHealth = 2;
-            e.shootCooldown = 0;
-            e.position = Vector3Add(game.player.position, {10, 0, -10});
-          }
-          e.health = e.maxHealth;
-          // Velocity init
-          // velocity removed from struct
-
-          break;
+      if (Enemy *slot = game.enemies.Spawn()) {
+        Enemy &e = *slot;
+        e.type = spawnType;
+        e.hitTimer = 0.0f;
+
+        // Stats
+        if (e.type == 2) { // Boss
+          e.maxHealth = 200;
+          e.shootCooldown = 0.5f;
+          e.position = {0, 1, -20};
+        } else if (e.type == 3) { // Tank
+          e.maxHealth = 20;
+          e.shootCooldown = 0;
+          e.position = Vector3Add(game.player.position, {10, 0, 10});
+        } else if (e.type == 1) { // Shooter
+          e.maxHealth = 5;
+          e.shootCooldown = 2.0f;
+          e.position = Vector3Add(game.player.position, {-10, 0, -10});
+        } else { // Chaser
+          e.maxHealth = 2;
+          e.shootCooldown = 0;
+          e.position = Vector3Add(game.player.position, {10, 0, -10});
         }
+        e.health = e.maxHealth;
+        // Velocity init
+        // velocity removed from struct
       }
     }
   }
@@ -890,8 +2348,8 @@ void UpdateGame() {
       currentSpeed *= 4.0f; // 4x speed during dash
       // Trail Particles
       Vector3 trailPos = Vector3Add(game.player.position,
-                                    {(float)GetRandomValue(-2, 2) / 10.0f, 0,
-                                     (float)GetRandomValue(-2, 2) / 10.0f});
+                                    {(float)fxRng.Range(-2, 2) / 10.0f, 0,
+                                     (float)fxRng.Range(-2, 2) / 10.0f});
       QueueExplosion(
           trailPos,
           GOLD); // Reuse spawn explosion for now, creates 5 small particles
@@ -937,86 +2395,62 @@ void UpdateGame() {
     }
   }
 
-  // --- Parallel Update Tasks ---
-  std::vector<std::future<void>> futures;
-
-  // 1. Bullet Update (Player) - Partitioned
-  const int bulletBatchSize = MAX_BULLETS / 4;
-  for (int i = 0; i < 4; ++i) {
-    int start = i * bulletBatchSize;
-    int end = (i == 3) ? MAX_BULLETS : (i + 1) * bulletBatchSize;
-    futures.emplace_back(threadPool->enqueue([dt, start, end] {
-      for (int j = start; j < end; ++j) {
-        auto &b = game.playerBullets[j];
-        if (b.active) {
-          b.position = Vector3Add(b.position, Vector3Scale(b.velocity, dt));
-          if (Vector3Length(b.position) > 100.0f ||
-              CheckBulletObstacles(b.position, b.radius))
-            b.active = false;
-        }
+  // --- Parallel Update Tasks (each phase joins before the next) ---
+  HEADLESS_PHASE(HS_COLLISION);
+  PROFILE_PHASE("UpdateBullets");
+  // 1. Bullet Update (Player) - Partitioned on mask words, SIMD kernel
+  jobSystem->ParallelFor(0, BULLET_WORDS, 4, [dt](int start, int end) {
+    UpdateBulletWords(game.playerBullets, start, end, dt, [](int, unsigned) {});
+  }, "PlayerBullets");
+
+  // 2. Bullet Update (Enemy) - Partitioned on mask words, SIMD kernel
+  jobSystem->ParallelFor(0, BULLET_WORDS, 4, [dt](int start, int end) {
+    BulletPool &pool = game.enemyBullets;
+    float combinedRadius = pool.radius + 0.5f;
+    vfloat hitR2 = VSet(combinedRadius * combinedRadius);
+    UpdateBulletWords(pool, start, end, dt, [&](int base, unsigned live) {
+      // Hit Player
+      Vector3 pp = game.player.position;
+      vfloat dx = VSub(VLoad(pool.x + base), VSet(pp.x));
+      vfloat dy = VSub(VLoad(pool.y + base), VSet(pp.y));
+      vfloat dz = VSub(VLoad(pool.z + base), VSet(pp.z));
+      vfloat d2 = VAdd(VAdd(VMul(dx, dx), VMul(dy, dy)), VMul(dz, dz));
+      unsigned hits = VMaskLess(d2, hitR2) & live;
+      if (!hits || game.player.dashTimer > 0.0f)
+        return;
+      for (; hits; hits &= hits - 1) {
+        int slot = base + std::countr_zero(hits);
+        if (pool.Deactivate(slot))
+          EmitEvent({.type = FrameEvent::PLAYER_HIT,
+                     .source = MAX_ENEMIES + slot});
       }
-    }));
-  }
-
-  // 2. Bullet Update (Enemy) - Partitioned
-  for (int i = 0; i < 4; ++i) {
-    int start = i * bulletBatchSize;
-    int end = (i == 3) ? MAX_BULLETS : (i + 1) * bulletBatchSize;
-    futures.emplace_back(threadPool->enqueue([dt, start, end] {
-      for (int j = start; j < end; ++j) {
-        auto &b = game.enemyBullets[j];
-        if (b.active) {
-          b.position = Vector3Add(b.position, Vector3Scale(b.velocity, dt));
-          if (Vector3Length(b.position) > 100.0f ||
-              CheckBulletObstacles(b.position, b.radius))
-            b.active = false;
-
-          // Hit Player
-          float distSq = Vector3DistanceSqr(b.position, game.player.position);
-          float combinedRadius = b.radius + 0.5f;
-          if (distSq < combinedRadius * combinedRadius) {
-            if (game.player.dashTimer <= 0.0f) {
-              game.player.health -= 5;
-              b.active = false;
-              QueueExplosion(game.player.position, RED);
-              if (game.player.health <= 0)
-                game.currentScreen = (int)SCREEN_GAMEOVER;
-            }
-          }
-        }
-      }
-    }));
-  }
+    });
+  }, "EnemyBullets");
 
-  // Wait for bullets to finish (since spawning depends on wave clear)
-  for (auto &f : futures)
-    f.get();
-  futures.clear();
+  // Bullets are settled here (spawning depends on wave clear)
+  // Broadphase for the enemy batches below (threat + hit queries)
+  bulletGrid.Build(game.playerBullets);
+  HEADLESS_PHASE(HS_NONE);
+  PROFILE_PHASE("Spawning");
 
   // --- Spawning (Sequential) ---
   if (game.enemiesSpawned < game.enemiesToSpawn) {
     game.spawnTimer -= dt;
     if (game.spawnTimer <= 0.0f) {
-      std::lock_guard<std::recursive_mutex> lock(gameMutex);
       // Check Boss (Every 5th wave)
       if (game.wave % 5 == 0 && game.enemiesSpawned == 0) {
-        for (auto &e : game.enemies) {
-          if (!e.active) {
-            e.active = true;
-            e.type = 2;
-            e.maxHealth = 8000 + (game.wave * 1000);
-            e.health = e.maxHealth;
-            e.position = {0, 1, -20};
-            e.shootCooldown = 0.5f;
-            e.hitTimer = 0.0f;
-            e.speed = 2.0f;
-            e.lastPosition = e.position;
-            e.stuckTimer = 0.0f;
-            game.enemiesToSpawn = 1;
-            game.enemiesSpawned++;
-            QueueSound(game.sfxEnemySpawn);
-            break;
-          }
+        if (Enemy *slot = game.enemies.Spawn()) {
+          Enemy &e = *slot;
+          e.type = 2;
+          e.maxHealth = 8000 + (game.wave * 1000);
+          e.health = e.maxHealth;
+          e.position = {0, 1, -20};
+          e.shootCooldown = 0.5f;
+          e.hitTimer = 0.0f;
+          e.speed = 2.0f;
+          game.enemiesToSpawn = 1;
+          game.enemiesSpawned++;
+          QueueSound(game.sfxEnemySpawn);
         }
         game.spawnTimer = 999.0f;
       } else if (game.wave % 5 != 0) {
@@ -1024,51 +2458,48 @@ void UpdateGame() {
         if (spawnRate < 0.2f)
           spawnRate = 0.2f;
         game.spawnTimer = spawnRate;
-        for (auto &e : game.enemies) {
-          if (!e.active) {
-            e.active = true;
-            int roll = GetRandomValue(0, 100);
-            if (game.wave >= 8 && roll > 95)
-              e.type = 6;
-            else if (game.wave >= 6 && roll > 85)
-              e.type = 5;
-            else if (game.wave >= 4 && roll > 75)
-              e.type = 4;
-            else if (game.wave >= 3 && roll > 60)
-              e.type = 3;
-            else if (game.wave >= 2 && roll > 40)
-              e.type = 1;
-            else
-              e.type = 0;
-
-            int difficulty = game.wave;
-            if (e.type == 6) {
-              e.maxHealth = 400 + (difficulty * 50);
-              e.shootCooldown = 3.0f;
-            } else if (e.type == 5) {
-              e.maxHealth = 500 + (difficulty * 60);
-              e.shootCooldown = 0;
-            } else if (e.type == 4) {
-              e.maxHealth = 250 + (difficulty * 40);
-              e.shootCooldown = 1.5f;
-            } else if (e.type == 3) {
-              e.maxHealth = 600 + (difficulty * 80);
-              e.shootCooldown = 0;
-            } else if (e.type == 1) {
-              e.maxHealth = 200 + (difficulty * 30);
-              e.shootCooldown = 2.0f;
-            } else {
-              e.maxHealth = 250 + (difficulty * 25);
-              e.shootCooldown = 0;
-            }
-            e.health = e.maxHealth;
-            e.hitTimer = 0.0f;
-            float angle = (float)GetRandomValue(0, 360) * DEG2RAD;
-            e.position = {cosf(angle) * 35.0f, 1.0f, sinf(angle) * 35.0f};
-            game.enemiesSpawned++;
-            QueueSound(game.sfxEnemySpawn);
-            break;
+        if (Enemy *slot = game.enemies.Spawn()) {
+          Enemy &e = *slot;
+          int roll = rng.Range(0, 100);
+          if (game.wave >= 8 && roll > 95)
+            e.type = 6;
+          else if (game.wave >= 6 && roll > 85)
+            e.type = 5;
+          else if (game.wave >= 4 && roll > 75)
+            e.type = 4;
+          else if (game.wave >= 3 && roll > 60)
+            e.type = 3;
+          else if (game.wave >= 2 && roll > 40)
+            e.type = 1;
+          else
+            e.type = 0;
+
+          int difficulty = game.wave;
+          if (e.type == 6) {
+            e.maxHealth = 400 + (difficulty * 50);
+            e.shootCooldown = 3.0f;
+          } else if (e.type == 5) {
+            e.maxHealth = 500 + (difficulty * 60);
+            e.shootCooldown = 0;
+          } else if (e.type == 4) {
+            e.maxHealth = 250 + (difficulty * 40);
+            e.shootCooldown = 1.5f;
+          } else if (e.type == 3) {
+            e.maxHealth = 600 + (difficulty * 80);
+            e.shootCooldown = 0;
+          } else if (e.type == 1) {
+            e.maxHealth = 200 + (difficulty * 30);
+            e.shootCooldown = 2.0f;
+          } else {
+            e.maxHealth = 250 + (difficulty * 25);
+            e.shootCooldown = 0;
           }
+          e.health = e.maxHealth;
+          e.hitTimer = 0.0f;
+          float angle = (float)rng.Range(0, 360) * DEG2RAD;
+          e.position = {cosf(angle) * 35.0f, 1.0f, sinf(angle) * 35.0f};
+          game.enemiesSpawned++;
+          QueueSound(game.sfxEnemySpawn);
         }
       }
     }
@@ -1078,346 +2509,248 @@ void UpdateGame() {
       if (e.active)
         allDead = false;
     if (allDead) {
-      std::lock_guard<std::recursive_mutex> lock(gameMutex);
       game.currentScreen = SCREEN_UPGRADE;
       game.spawnTimer = 2.0f;
     }
   }
 
   // 3. Enemy Update (Parallelized AI and Collision) - Partitioned
-  const int enemyBatchSize = MAX_ENEMIES / 4;
-  for (int i = 0; i < 4; ++i) {
-    int start = i * enemyBatchSize;
-    int end = (i == 3) ? MAX_ENEMIES : (i + 1) * enemyBatchSize;
-    futures.emplace_back(threadPool->enqueue([dt, start, end] {
-      for (int k = start; k < end; ++k) {
-        auto &e = game.enemies[k];
-        if (e.active) {
-          // Update timers
-          e.dashTimer -= dt;
-          e.dashCooldown -= dt;
-
-          Vector3 dir = Vector3Subtract(game.player.position, e.position);
-          float dist = Vector3Length(dir);
-          dir = Vector3Normalize(dir);
-
-          // AI Logic
-          float speedMult = (game.player.focusMode ? 0.5f : 1.0f);
-          Vector3 moveDir = dir;
-          bool isStuck = false;
-          bool shouldDash = false;
-
-          float movementThisFrame = Vector3Distance(e.position, e.lastPosition);
-          if (movementThisFrame < 0.05f * dt) {
-            e.stuckTimer += dt;
-            if (e.stuckTimer > 0.2f) {
-              isStuck = true;
-              e.stuckTimer = 0.0f;
+  // Each batch moves only its own enemies; everything else becomes an event
+  // (see FrameEvent) that is committed after the join.
+  HEADLESS_PHASE(HS_ENEMIES);
+  PROFILE_PHASE("UpdateEnemies");
+  flowField.Update(game.player.position);
+  jobSystem->ParallelFor(0, game.enemies.count, 8, [dt](int start, int end) {
+    for (int j = start; j < end; ++j) {
+      int k = game.enemies.live[j];
+      auto &e = game.enemies[k];
+      if (e.active) {
+        // Update timers
+        e.dashTimer -= dt;
+        e.dashCooldown -= dt;
+
+        Vector3 dir = Vector3Subtract(game.player.position, e.position);
+        float dist = Vector3Length(dir);
+        dir = Vector3Normalize(dir);
+
+        // AI Logic
+        float speedMult = (game.player.focusMode ? 0.5f : 1.0f);
+        Vector3 moveDir = dir;
+        bool shouldDash = false;
+
+        if (e.type != 2 && e.type != 3) {
+          const float threatRange = 4.0f;
+          float closestThreat = threatRange;
+          Vector3 threatDir = {0, 0, 0};
+          Vector3 threatPos = {0, 0, 0};
+          bulletGrid.Query(e.position, threatRange, [&](int bi) {
+            const BulletPool &pool = game.playerBullets;
+            if (!pool.IsActive(bi))
+              return true;
+            Vector3 bulletPos = pool.Position(bi);
+            float distToBullet = Vector3Distance(bulletPos, e.position);
+            if (distToBullet >= closestThreat)
+              return true;
+            Vector3 bulletDir = Vector3Normalize(pool.Velocity(bi));
+            Vector3 toBullet = Vector3Subtract(bulletPos, e.position);
+            float dotProduct =
+                Vector3DotProduct(bulletDir, Vector3Normalize(toBullet));
+            if (dotProduct < -0.5f) {
+              closestThreat = distToBullet;
+              threatDir = bulletDir;
+              threatPos = bulletPos;
             }
-          } else {
-            e.stuckTimer = 0.0f;
-          }
-          e.lastPosition = e.position;
-
-          if (isStuck && e.dashCooldown <= 0.0f) {
+            return true;
+          });
+          if (closestThreat < threatRange && e.dashCooldown <= 0.0f) {
             shouldDash = true;
-            float randomAngle = (float)GetRandomValue(0, 360) * DEG2RAD;
-            moveDir = {cosf(randomAngle), 0, sinf(randomAngle)};
-          } else if (e.type != 2 && e.type != 3) {
-            float closestThreat = 999.0f;
-            Vector3 threatDir = {0, 0, 0};
-            for (const auto &b : game.playerBullets) {
-              if (!b.active)
-                continue;
-              float distToBullet = Vector3Distance(b.position, e.position);
-              Vector3 bulletDir = Vector3Normalize(b.velocity);
-              Vector3 toBullet = Vector3Subtract(b.position, e.position);
-              float dotProduct =
-                  Vector3DotProduct(bulletDir, Vector3Normalize(toBullet));
-              if (dotProduct < -0.5f && distToBullet < closestThreat) {
-                closestThreat = distToBullet;
-                threatDir = bulletDir;
-              }
-            }
-            if (closestThreat < 4.0f && e.dashCooldown <= 0.0f) {
-              shouldDash = true;
-              Vector3 dodgeDir = {threatDir.z, 0, -threatDir.x};
-              if (GetRandomValue(0, 1))
-                dodgeDir = Vector3Negate(dodgeDir);
-              moveDir = dodgeDir;
-            }
+            // Sidestep away from the bullet's line of travel
+            Vector3 dodgeDir = {threatDir.z, 0, -threatDir.x};
+            if (Vector3DotProduct(dodgeDir,
+                                  Vector3Subtract(e.position, threatPos)) < 0)
+              dodgeDir = Vector3Negate(dodgeDir);
+            moveDir = dodgeDir;
           }
+        }
 
-          if (!shouldDash && e.dashTimer <= 0.0f) {
-            float lookAhead = (e.type == 3) ? 2.0f : 3.5f;
-            Vector3 avoidDir =
-                GetAvoidanceDirection(e.position, moveDir, lookAhead);
-            if (Vector3Length(Vector3Subtract(avoidDir, moveDir)) > 0.1f)
-              moveDir = Vector3Normalize(Vector3Lerp(moveDir, avoidDir, 0.85f));
-          }
+        if (!shouldDash && e.dashTimer <= 0.0f)
+          moveDir = flowField.Sample(e.position, dir);
 
-          if (shouldDash) {
-            e.dashTimer = 0.2f;
-            e.dashCooldown = 2.0f;
-          }
+        if (shouldDash) {
+          e.dashTimer = 0.2f;
+          e.dashCooldown = 2.0f;
+        }
 
-          float dashBoost = (e.dashTimer > 0.0f) ? 15.0f : 1.0f;
+        float dashBoost = (e.dashTimer > 0.0f) ? 15.0f : 1.0f;
 
-          // Type Specific Movement
-          if (e.type == 0 || e.type == 4) {
-            Vector3 newPos = Vector3Add(
-                e.position,
-                Vector3Scale(moveDir, 5.0f * speedMult * dashBoost * dt));
-            if (e.type == 4) {
-              e.shootCooldown -= dt;
-              if (e.shootCooldown <= 0.0f) {
-                e.shootCooldown = 1.5f;
-                Vector3 blinkTarget =
-                    Vector3Add(e.position, Vector3Scale(moveDir, 6.0f));
-                if (!CheckEntityObstacleCollision(blinkTarget, 0.5f)) {
-                  e.position = blinkTarget;
-                  QueueExplosion(e.position, MAGENTA);
-                  QueueSound(game.sfxBlinker);
-                }
-              }
-            }
-            if (e.dashTimer > 0.0f ||
-                !CheckEntityObstacleCollision(newPos, 0.5f))
-              e.position = newPos;
-          } else if (e.type == 6) {
-            Vector3 newPos = Vector3Add(
-                e.position, Vector3Scale(moveDir, 2.0f * speedMult * dt));
-            if (!CheckEntityObstacleCollision(newPos, 0.5f))
-              e.position = newPos;
+        // Type Specific Movement
+        if (e.type == 0 || e.type == 4) {
+          Vector3 newPos = Vector3Add(
+              e.position,
+              Vector3Scale(moveDir, 5.0f * speedMult * dashBoost * dt));
+          if (e.type == 4) {
             e.shootCooldown -= dt;
             if (e.shootCooldown <= 0.0f) {
-              e.shootCooldown = 3.0f;
-              QueueExplosion(e.position, SKYBLUE);
-              for (auto &other : game.enemies) {
-                if (other.active &&
-                    Vector3DistanceSqr(e.position, other.position) < 64.0f) {
-                  other.health += 10;
-                  if (other.health > other.maxHealth)
-                    other.health = other.maxHealth;
-                }
+              e.shootCooldown = 1.5f;
+              Vector3 blinkTarget =
+                  Vector3Add(e.position, Vector3Scale(moveDir, 6.0f));
+              if (!CheckEntityObstacleCollision(blinkTarget, 0.5f)) {
+                e.position = blinkTarget;
+                EmitEvent({.type = FrameEvent::EXPLOSION,
+                           .source = k,
+                           .pos = e.position,
+                           .color = MAGENTA});
+                EmitEvent({.type = FrameEvent::SOUND,
+                           .source = k,
+                           .sfx = &game.sfxBlinker});
               }
             }
-          } else if (e.type == 1) {
-            if (e.dashTimer > 0.0f) {
-              e.position = Vector3Add(
-                  e.position,
-                  Vector3Scale(moveDir, 4.0f * speedMult * dashBoost * dt));
+          }
+          if (e.dashTimer > 0.0f ||
+              !CheckEntityObstacleCollision(newPos, 0.5f))
+            e.position = newPos;
+        } else if (e.type == 6) {
+          Vector3 newPos = Vector3Add(
+              e.position, Vector3Scale(moveDir, 2.0f * speedMult * dt));
+          if (!CheckEntityObstacleCollision(newPos, 0.5f))
+            e.position = newPos;
+          e.shootCooldown -= dt;
+          if (e.shootCooldown <= 0.0f) {
+            e.shootCooldown = 3.0f;
+            EmitEvent({.type = FrameEvent::SUPPORT_PULSE, .source = k});
+          }
+        } else if (e.type == 1) {
+          if (e.dashTimer > 0.0f) {
+            e.position = Vector3Add(
+                e.position,
+                Vector3Scale(moveDir, 4.0f * speedMult * dashBoost * dt));
+          } else {
+            float idealDist = 12.0f;
+            if (dist > idealDist + 3.0f) {
+              Vector3 newPos = Vector3Add(
+                  e.position, Vector3Scale(moveDir, 4.0f * speedMult * dt));
+              if (!CheckEntityObstacleCollision(newPos, 0.5f))
+                e.position = newPos;
+            } else if (dist < idealDist - 3.0f) {
+              Vector3 newPos = Vector3Subtract(
+                  e.position, Vector3Scale(moveDir, 3.0f * dt));
+              if (!CheckEntityObstacleCollision(newPos, 0.5f))
+                e.position = newPos;
             } else {
-              float idealDist = 12.0f;
-              if (dist > idealDist + 3.0f) {
-                Vector3 newPos = Vector3Add(
-                    e.position, Vector3Scale(moveDir, 4.0f * speedMult * dt));
-                if (!CheckEntityObstacleCollision(newPos, 0.5f))
-                  e.position = newPos;
-              } else if (dist < idealDist - 3.0f) {
-                Vector3 newPos = Vector3Subtract(
-                    e.position, Vector3Scale(moveDir, 3.0f * dt));
-                if (!CheckEntityObstacleCollision(newPos, 0.5f))
-                  e.position = newPos;
-              } else {
-                Vector3 strafeDir = {moveDir.z, 0, -moveDir.x};
-                Vector3 newPos =
-                    Vector3Add(e.position, Vector3Scale(strafeDir, 2.0f * dt));
-                if (!CheckEntityObstacleCollision(newPos, 0.5f))
-                  e.position = newPos;
-              }
-            }
-            e.shootCooldown -= dt;
-            if (e.shootCooldown <= 0.0f) {
-              e.shootCooldown = 2.5f;
-              SpawnEnemyBullet(e.position, Vector3Scale(dir, 15.0f));
-              QueueSound(game.sfxEnemyShoot);
-            }
-          } else if (e.type == 2) {
-            e.position.x += sinf(GetTime()) * dt * 5.0f;
-            e.position.z += cosf(GetTime() * 0.5f) * dt * 2.0f;
-            e.shootCooldown -= dt;
-            if (e.shootCooldown <= 0.0f) {
-              e.shootCooldown = 0.15f;
-              static float spiralAngle = 0.0f;
-              spiralAngle += 20.0f;
-              if (spiralAngle > 360)
-                spiralAngle -= 360;
-              Vector3 shotDir = {cosf(spiralAngle * DEG2RAD), 0,
-                                 sinf(spiralAngle * DEG2RAD)};
-              SpawnEnemyBullet(e.position, Vector3Scale(shotDir, 15.0f));
-              SpawnEnemyBullet(e.position,
-                               Vector3Scale(Vector3Negate(shotDir), 15.0f));
-              QueueSound(game.sfxEnemyShoot);
+              Vector3 strafeDir = {moveDir.z, 0, -moveDir.x};
+              Vector3 newPos =
+                  Vector3Add(e.position, Vector3Scale(strafeDir, 2.0f * dt));
+              if (!CheckEntityObstacleCollision(newPos, 0.5f))
+                e.position = newPos;
             }
-          } else if (e.type == 3) {
-            Vector3 newPos = Vector3Add(
-                e.position, Vector3Scale(moveDir, 2.5f * speedMult * dt));
-            if (!CheckEntityObstacleCollision(newPos, 0.8f))
-              e.position = newPos;
-            else
-              e.position =
-                  Vector3Subtract(e.position, Vector3Scale(moveDir, 0.5f * dt));
           }
-
-          e.hitTimer -= dt;
-
-          // Collision Logic
-          float radius = (e.type == 2) ? 3.0f : (e.type == 3 ? 0.8f : 0.5f);
-          float playerDistSq =
-              Vector3DistanceSqr(game.player.position, e.position);
-          float combinedPlayerR = 0.5f + radius;
-          if (playerDistSq < combinedPlayerR * combinedPlayerR) {
-            if (game.player.dashTimer <= 0.0f && e.hitTimer <= 0.0f) {
-              game.player.health -= 10;
-              e.health -= 50; // Damage the enemy too
-              e.hitTimer = 0.2f;
-              AtomicMax(game.hitShake.val, 0.5f);
-
-              QueueSound(game.sfxHit);
-              QueueExplosion(e.position, ORANGE);
-
-              // Knockback
-              Vector3 kb = Vector3Normalize(
-                  Vector3Subtract(game.player.position, e.position));
-              game.player.position =
-                  Vector3Add(game.player.position, Vector3Scale(kb, 1.0f));
-              e.position = Vector3Subtract(e.position, Vector3Scale(kb, 1.0f));
-
-              if (e.health <= 0 && e.type != 2) {
-                e.active = false;
-                game.player.xp += (e.type == 3 ? 100 : 25);
-                game.score += (e.type == 3 ? 150 : 50);
-                QueueSound(game.sfxExplosion);
-              }
-
-              if (game.player.health <= 0)
-                game.currentScreen = (int)SCREEN_GAMEOVER;
-            } else if (game.player.dashTimer > 0.0f && e.type != 2) {
-              // Dashing through kills weak enemies
-              game.player.xp += (e.type == 3 ? 100 : 25);
-              game.score += (e.type == 3 ? 150 : 50);
-              e.active = false;
-              QueueSound(game.sfxExplosion);
-              QueueExplosion(e.position, ORANGE);
-            }
+          e.shootCooldown -= dt;
+          if (e.shootCooldown <= 0.0f) {
+            e.shootCooldown = 2.5f;
+            EmitEvent({.type = FrameEvent::ENEMY_SHOT,
+                       .source = k,
+                       .pos = e.position,
+                       .vec = Vector3Scale(dir, 15.0f)});
+            EmitEvent({.type = FrameEvent::SOUND,
+                       .source = k,
+                       .sfx = &game.sfxEnemyShoot});
           }
-
-          for (auto &b : game.playerBullets) {
-            if (b.active) {
-              radius = (e.type == 2) ? 3.0f : (e.type == 3 ? 0.8f : 0.5f);
-              float bulletDistSq = Vector3DistanceSqr(b.position, e.position);
-              float combinedBulletR = b.radius + radius;
-              if (bulletDistSq < combinedBulletR * combinedBulletR) {
-                float damage = 20.0f * game.player.damageMult;
-                bool isCrit = false;
-                if ((float)GetRandomValue(0, 1000) / 1000.0f <
-                    game.player.critChance) {
-                  damage *= 2.0f;
-                  isCrit = true;
-                }
-                e.health -= (int)damage;
-                e.hitTimer = 0.1f;
-                b.active = false;
-                QueueExplosion(b.position, WHITE);
-
-                float knockbackValue =
-                    (e.type == 2) ? 0.1f : (e.type == 3 ? 0.2f : 0.5f);
-                Vector3 knockDir =
-                    Vector3Scale(Vector3Normalize(b.velocity), knockbackValue);
-                e.position = Vector3Add(e.position, knockDir);
-
-                if (isCrit) {
-                  AtomicMax(game.hitStopTimer.val, 0.08f);
-                  AtomicMax(game.hitShake.val, 0.3f);
-                  QueueText(e.position, TextFormat("%d CRIT!", (int)damage),
-                            GOLD);
-                } else {
-                  AtomicMax(game.hitStopTimer.val, 0.05f);
-                  AtomicMax(game.hitShake.val, 0.15f);
-                  QueueText(e.position, TextFormat("%d", (int)damage), WHITE);
-                }
-
-                if (e.health <= 0) {
-                  AtomicMax(game.hitStopTimer.val, 0.12f);
-                  AtomicMax(game.hitShake.val, 0.5f);
-                  e.active = false;
-                  QueueSound(game.sfxExplosion);
-                  Color ec = (e.type == 2)   ? PURPLE
-                             : (e.type == 3) ? DARKGREEN
-                             : (e.type == 1) ? MAROON
-                             : (e.type == 4) ? MAGENTA
-                             : (e.type == 5) ? LIME
-                             : (e.type == 6) ? SKYBLUE
-                                             : RED;
-                  QueueExplosion(e.position, ec);
-
-                  if (e.type == 5) {
-                    int spawned = 0;
-                    for (auto &bit : game.enemies) {
-                      if (!bit.active && spawned < 3) {
-                        bit.active = true;
-                        bit.type = 0;
-                        bit.maxHealth = 40;
-                        bit.health = 40;
-                        bit.speed = 8.0f;
-                        bit.position = Vector3Add(
-                            e.position, {(float)GetRandomValue(-1, 1), 0,
-                                         (float)GetRandomValue(-1, 1)});
-                        bit.hitTimer = 0.0f;
-                        bit.lastPosition = bit.position;
-                        bit.stuckTimer = 0.0f;
-                        spawned++;
-                      }
-                    }
-                  }
-                  game.player.xp +=
-                      (e.type == 2 ? 500 : (e.type == 3 ? 100 : 25));
-                  game.score += (e.type == 2 ? 1000 : (e.type == 3 ? 150 : 50));
-                  CheckLevelUp();
-                }
-                break;
-              }
-            }
+        } else if (e.type == 2) {
+          e.position.x += sinf(GetTime()) * dt * 5.0f;
+          e.position.z += cosf(GetTime() * 0.5f) * dt * 2.0f;
+          e.shootCooldown -= dt;
+          if (e.shootCooldown <= 0.0f) {
+            e.shootCooldown = 0.15f;
+            static float spiralAngle = 0.0f;
+            spiralAngle += 20.0f;
+            if (spiralAngle > 360)
+              spiralAngle -= 360;
+            Vector3 shotDir = {cosf(spiralAngle * DEG2RAD), 0,
+                               sinf(spiralAngle * DEG2RAD)};
+            EmitEvent({.type = FrameEvent::ENEMY_SHOT,
+                       .source = k,
+                       .pos = e.position,
+                       .vec = Vector3Scale(shotDir, 15.0f)});
+            EmitEvent({.type = FrameEvent::ENEMY_SHOT,
+                       .source = k,
+                       .pos = e.position,
+                       .vec = Vector3Scale(shotDir, -15.0f)});
+            EmitEvent({.type = FrameEvent::SOUND,
+                       .source = k,
+                       .sfx = &game.sfxEnemyShoot});
           }
+        } else if (e.type == 3) {
+          Vector3 newPos = Vector3Add(
+              e.position, Vector3Scale(moveDir, 2.5f * speedMult * dt));
+          if (!CheckEntityObstacleCollision(newPos, 0.8f))
+            e.position = newPos;
+          else
+            e.position =
+                Vector3Subtract(e.position, Vector3Scale(moveDir, 0.5f * dt));
         }
-      }
-    }));
-  }
-
-  // 4. Particle Update (Fine-Grained Partitioning: 8 Batches)
-  const int particleBatchSize = MAX_PARTICLES / 8;
-  for (int i = 0; i < 8; ++i) {
-    int start = i * particleBatchSize;
-    int end = (i == 7) ? MAX_PARTICLES : (i + 1) * particleBatchSize;
-    futures.emplace_back(threadPool->enqueue([dt, start, end] {
-      for (int j = start; j < end; ++j) {
-        auto &p = game.particles[j];
-        if (p.active) {
-          p.position = Vector3Add(p.position, Vector3Scale(p.velocity, dt));
-          p.life -= p.decay * dt;
-          if (p.life <= 0)
-            p.active = false;
+
+        e.hitTimer -= dt;
+
+        // Collision Logic
+        float radius = (e.type == 2) ? 3.0f : (e.type == 3 ? 0.8f : 0.5f);
+        float playerDistSq =
+            Vector3DistanceSqr(game.player.position, e.position);
+        float combinedPlayerR = 0.5f + radius;
+        if (playerDistSq < combinedPlayerR * combinedPlayerR) {
+          if (game.player.dashTimer <= 0.0f && e.hitTimer <= 0.0f)
+            EmitEvent({.type = FrameEvent::ENEMY_CONTACT, .source = k});
+          else if (game.player.dashTimer > 0.0f && e.type != 2)
+            // Dashing kills weak ones
+            EmitEvent({.type = FrameEvent::ENEMY_DASHED, .source = k});
         }
-      }
-    }));
-  }
 
-  // 5. Floating Text Update
-  futures.emplace_back(threadPool->enqueue([dt] {
-    for (auto &ft : game.floatingTexts) {
-      if (ft.active) {
-        ft.position.y += ft.speed * dt;
-        ft.life -= dt;
-        if (ft.life <= 0)
-          ft.active = false;
+        // Bullets are claimed at commit, so report every overlapping one
+        float hitRange = radius + PLAYER_BULLET_RADIUS;
+        bulletGrid.Query(e.position, hitRange, [&](int bi) {
+          const BulletPool &pool = game.playerBullets;
+          Vector3 bulletPos = pool.Position(bi);
+          float bulletDistSq = Vector3DistanceSqr(bulletPos, e.position);
+          float combinedBulletR = pool.radius + radius;
+          if (bulletDistSq < combinedBulletR * combinedBulletR)
+            EmitEvent({.type = FrameEvent::BULLET_HIT,
+                       .source = k,
+                       .bullet = bi,
+                       .pos = bulletPos,
+                       .vec = Vector3Normalize(pool.Velocity(bi))});
+          return true;
+        });
       }
     }
-  }));
-
-  // Final Join
-  for (auto &f : futures)
-    f.get();
+  }, "EnemyBatch");
+  CommitFrameEvents();
+  game.enemies.Sweep();
+
+  // 4. Particle Update (Fine-Grained Partitioning, stolen by idle workers)
+  HEADLESS_PHASE(HS_PARTICLES);
+  PROFILE_PHASE("UpdateParticles");
+  int liveParticles = game.particles.count;
+  jobSystem->ParallelFor(0, liveParticles, 256, [dt](int start, int end) {
+    for (int j = start; j < end; ++j) {
+      auto &p = game.particles.Live(j);
+      p.position = Vector3Add(p.position, Vector3Scale(p.velocity, dt));
+      p.life -= p.decay * dt;
+      if (p.life <= 0)
+        p.active = false;
+    }
+  }, "ParticleBatch");
+  game.particles.Sweep();
+
+  HEADLESS_PHASE(HS_NONE);
+  PROFILE_PHASE("UpdateTail");
+
+  // 5. Floating Text Update (too small to be worth a job)
+  for (auto &ft : game.floatingTexts) {
+    ft.position.y += ft.speed * dt;
+    ft.life -= dt;
+    if (ft.life <= 0)
+      ft.active = false;
+  }
+  game.floatingTexts.Sweep();
 
   // --- Camera Follow & Breathing ---
   float time = (float)GetTime();
@@ -1440,24 +2773,30 @@ void UpdateGame() {
   }
 
   CheckLevelUp();
+  PROFILE_PHASE(nullptr);
+  HEADLESS_PHASE(HS_PARTICLES); // Explosions spawn their particles here
   ProcessEffectBuffer();
+  HEADLESS_PHASE(HS_NONE);
 }
 
 void DrawGame() {
+  PROFILE_ZONE("DrawGame");
   // 1. Draw 3D Scene to Texture
+  PROFILE_PHASE("DrawScene");
   BeginTextureMode(target);
   ClearBackground(BLACK);
+  rlViewport(0, 0, DynResWidth(), DynResHeight());
 
   if (game.currentScreen == SCREEN_PLAYING) {
     // Screen Shake (Hit + Glitch)
     Vector3 shake = {0};
     if (game.player.health < 30) {
-      shake.x += (float)GetRandomValue(-2, 2) / 10.0f;
-      shake.y += (float)GetRandomValue(-2, 2) / 10.0f;
+      shake.x += (float)fxRng.Range(-2, 2) / 10.0f;
+      shake.y += (float)fxRng.Range(-2, 2) / 10.0f;
     }
     if (game.hitShake > 0) {
-      shake.x += (float)GetRandomValue(-100, 100) / 100.0f * game.hitShake;
-      shake.z += (float)GetRandomValue(-100, 100) / 100.0f * game.hitShake;
+      shake.x += (float)fxRng.Range(-100, 100) / 100.0f * game.hitShake;
+      shake.z += (float)fxRng.Range(-100, 100) / 100.0f * game.hitShake;
     }
 
     BeginMode3D(game.camera);
@@ -1503,35 +2842,37 @@ void DrawGame() {
     }
 
     // Draw Bullets (Player)
-    for (const auto &b : game.playerBullets) {
-      if (b.active) {
-        // Trail
-        DrawLine3D(
-            b.position,
-            Vector3Subtract(b.position,
-                            Vector3Scale(Vector3Normalize(b.velocity), 1.0f)),
-            b.color);
-        // Glow
-        DrawSphere(b.position, b.radius * 2.5f, ColorAlpha(b.color, 0.4f));
-        // Core
-        DrawSphere(b.position, b.radius, WHITE);
+    const float trail = Quality().bulletTrail;
+    const BulletPool &pb = game.playerBullets;
+    pb.ForEachActive([&](int i) {
+      Vector3 pos = pb.Position(i);
+      // Trail
+      if (trail > 0.0f) {
+        Vector3 back = Vector3Scale(Vector3Normalize(pb.Velocity(i)), trail);
+        DrawLine3D(pos, Vector3Subtract(pos, back), pb.color);
       }
-    }
+      // Glow
+      DrawInstance(sphereBatch, pos, pb.radius * 2.5f,
+                   ColorAlpha(pb.color, 0.4f));
+      // Core
+      DrawInstance(sphereBatch, pos, pb.radius, WHITE);
+    });
     // Draw Bullets (Enemy)
-    for (const auto &b : game.enemyBullets) {
-      if (b.active) {
-        // Trail
-        DrawLine3D(
-            b.position,
-            Vector3Subtract(b.position,
-                            Vector3Scale(Vector3Normalize(b.velocity), 1.0f)),
-            b.color);
-        // Glow (Increased for better readability)
-        DrawSphere(b.position, b.radius * 4.0f, ColorAlpha(b.color, 0.5f));
-        // Core
-        DrawSphere(b.position, b.radius, WHITE);
+    const BulletPool &eb = game.enemyBullets;
+    eb.ForEachActive([&](int i) {
+      Vector3 pos = eb.Position(i);
+      // Trail
+      if (trail > 0.0f) {
+        Vector3 back = Vector3Scale(Vector3Normalize(eb.Velocity(i)), trail);
+        DrawLine3D(pos, Vector3Subtract(pos, back), eb.color);
       }
-    }
+      // Glow (Increased for better readability)
+      DrawInstance(sphereBatch, pos, eb.radius * 4.0f,
+                   ColorAlpha(eb.color, 0.5f));
+      // Core
+      DrawInstance(sphereBatch, pos, eb.radius, WHITE);
+    });
+    FlushInstances(sphereBatch);
 
     // Draw Enemies
     for (const auto &enemy : game.enemies) {
@@ -1581,9 +2922,10 @@ void DrawGame() {
       if (p.active) {
         Color c = p.color;
         c.a = (unsigned char)(255.0f * (p.life > 1.0f ? 1.0f : p.life));
-        DrawCube(p.position, p.size, p.size, p.size, c);
+        DrawInstance(cubeBatch, p.position, p.size, c);
       }
     }
+    FlushInstances(cubeBatch);
     // Draw Floating Text (3D)
     for (const auto &ft : game.floatingTexts) {
       if (ft.active) {
@@ -1636,23 +2978,34 @@ void DrawGame() {
   EndTextureMode();
 
   // 2. Draw Texture to Screen with Shader
+  PROFILE_PHASE("PostProcess");
   BeginDrawing();
   ClearBackground(BLACK);
-  BeginShaderMode(postProcessShader);
+  // Only the scene corner of the target is live; crt.fs maps it to full UVs
+  Vector2 uvScale = {(float)DynResWidth() / target.texture.width,
+                     (float)DynResHeight() / target.texture.height};
+  if (Quality().postProcess) {
+    SetShaderValue(postProcessShader,
+                   GetShaderLocation(postProcessShader, "uvScale"), &uvScale,
+                   SHADER_UNIFORM_VEC2);
+    BeginShaderMode(postProcessShader);
+  }
   // Note: RenderTextures are y-flipped in OpenGL
-  DrawTextureRec(
-      target.texture,
-      {0, 0, (float)target.texture.width, (float)-target.texture.height},
-      {0, 0}, WHITE);
-  EndShaderMode();
+  DrawTexturePro(target.texture,
+                 {0, 0, (float)DynResWidth(), (float)-DynResHeight()},
+                 {0, 0, (float)SCREEN_WIDTH, (float)SCREEN_HEIGHT}, {0, 0},
+                 0.0f, WHITE);
+  if (Quality().postProcess)
+    EndShaderMode();
 
   // 3. Draw UI on TOP of Shader (crisp text)
+  PROFILE_PHASE("DrawUI");
   if (game.currentScreen == SCREEN_PLAYING) {
     DrawText(TextFormat("WAVE: %i", game.wave), 20, 20, 20, PURPLE);
     DrawText(TextFormat("SCORE: %06i", (int)game.score), 20, 50, 20, GREEN);
 
     // Health Bar (with vibration)
-    int hv = (game.hitShake > 0.1f) ? GetRandomValue(-4, 4) : 0;
+    int hv = (game.hitShake > 0.1f) ? fxRng.Range(-4, 4) : 0;
     DrawRectangle(20 + hv, 80 + hv, 200, 20, DARKGRAY);
     DrawRectangle(
         20 + hv, 80 + hv,
@@ -1710,9 +3063,21 @@ void DrawGame() {
 
     if (game.debugMode) {
       DrawText("DEBUG MODE ACTIVE", 20, 140, 20, GREEN);
-      DrawText("1:Bug 2:Sht 3:Boss 4:Tnk", 20, 160, 10, LIME);
+      DrawText("1:Bug 2:Sht 3:Boss 4:Tnk 9:DynRes", 20, 160, 10, LIME);
+      DrawText(TextFormat("FX DROPPED: %i", effectBuffer.Overflow()), 20, 175,
+               10, LIME);
+      DrawText(TextFormat("LIVE E:%i P:%i  PARTICLES DROPPED: %i",
+                          game.enemies.count, game.particles.count,
+                          game.particles.dropped),
+               20, 190, 10, LIME);
+      DrawText(TextFormat("QUALITY: %s  RENDER SCALE: %i%%%s", Quality().name,
+                          (int)(dynRes.scale * 100.0f),
+                          dynRes.enabled ? " (DYN)" : ""),
+               20, 205, 10, LIME);
     }
   }
+  PROFILE_OVERLAY();
+  PROFILE_PHASE("EndDrawing"); // Buffer swap; absorbs GPU and vsync waits
   EndDrawing();
 }
 
@@ -1746,7 +3111,12 @@ void DrawMenu() {
 }
 
 void UpdateDrawFrame() {
+  PROFILE_FRAME();
+  StatsBeginFrame();
+  QualityObserve(GetFrameTime() * 1000.0f);
+  DynResUpdate(GetFrameTime() * 1000.0f);
   UpdateGame();
+  StatsEndSim();
 
   // Handle Looping BGM
   if (!IsSoundPlaying(game.sfxBonus)) {
@@ -1758,47 +3128,137 @@ void UpdateDrawFrame() {
   } else {
     DrawGame();
   }
+  StatsEndDraw();
 }
 
 void SpawnExplosion(Vector3 pos, Color color) { QueueExplosion(pos, color); }
 
 void ProcessEffectBuffer() {
-  std::lock_guard<std::mutex> lock(bufferMutex);
-  while (!effectBuffer.empty()) {
-    EffectCommand cmd = effectBuffer.front();
-    effectBuffer.pop_front();
+  PROFILE_ZONE("ProcessEffectBuffer");
+  StatsSampleEffectQueue(effectBuffer.Depth());
+  const int burst = QualityParticles(20); // Particles per explosion
+  EffectCommand cmd;
+  while (effectBuffer.Pop(cmd)) {
 
     if (cmd.type == EffectCommand::EXPLOSION) {
-      for (int i = 0; i < 20; ++i) {
-        int idx = game.particleRollingIdx % MAX_PARTICLES;
-        auto &p = game.particles[idx];
-        p.active = true;
+      for (int i = 0; i < burst; ++i) {
+        Particle *slot = game.particles.Spawn();
+        if (!slot)
+          break; // Full: drop the rest rather than overwrite live ones
+        auto &p = *slot;
         p.position = cmd.pos;
-        float angle = (float)GetRandomValue(0, 360) * DEG2RAD;
-        float speed = (float)GetRandomValue(5, 15) / 10.0f;
-        p.velocity = {cosf(angle) * speed, (float)GetRandomValue(-5, 5) / 10.0f,
+        float angle = (float)fxRng.Range(0, 360) * DEG2RAD;
+        float speed = (float)fxRng.Range(5, 15) / 10.0f;
+        p.velocity = {cosf(angle) * speed, (float)fxRng.Range(-5, 5) / 10.0f,
                       sinf(angle) * speed};
         p.color = cmd.color;
-        p.size = (float)GetRandomValue(1, 4) / 10.0f;
+        p.size = (float)fxRng.Range(1, 4) / 10.0f;
         p.life = 1.0f;
-        p.decay = (float)GetRandomValue(50, 100) / 10.0f;
-        game.particleRollingIdx++;
+        p.decay = (float)fxRng.Range(50, 100) / 10.0f;
       }
     } else if (cmd.type == EffectCommand::SOUND) {
       PlaySound(cmd.sfx);
     } else if (cmd.type == EffectCommand::TEXT) {
-      for (auto &ft : game.floatingTexts) {
-        if (!ft.active) {
-          ft.active = true;
-          ft.position = cmd.pos;
-          strncpy(ft.text, cmd.text, 31);
-          ft.text[31] = '\0';
-          ft.color = cmd.color;
-          ft.life = 1.0f;
-          ft.speed = 2.0f;
-          break;
-        }
+      if (FloatingText *ft = game.floatingTexts.Spawn()) {
+        ft->position = cmd.pos;
+        memcpy(ft->text, cmd.text, sizeof(ft->text));
+        ft->text[sizeof(ft->text) - 1] = '\0';
+        ft->color = cmd.color;
+        ft->life = 1.0f;
+        ft->speed = 2.0f;
       }
     }
   }
 }
+
+// --- Headless Benchmark ---
+#ifdef HEADLESS
+// Deterministic input script: circle-strafe while shooting at the nearest
+// enemy, dash on a fixed rhythm, and advance through the menu, upgrade and
+// game-over screens.
+static void HeadlessScriptInput(int frame) {
+  memset(headless.keyDown, 0, sizeof(headless.keyDown));
+  memset(headless.keyPressed, 0, sizeof(headless.keyPressed));
+  memset(headless.mouseDown, 0, sizeof(headless.mouseDown));
+
+  const int walkKeys[4] = {KEY_W, KEY_D, KEY_S, KEY_A};
+  headless.keyDown[walkKeys[(frame / 60) % 4]] = true;
+  headless.mouseDown[MOUSE_BUTTON_LEFT] = true;
+  if (frame % 120 == 0 || game.currentScreen == SCREEN_MENU)
+    headless.keyPressed[KEY_SPACE] = true;
+  if (game.currentScreen == SCREEN_UPGRADE)
+    headless.keyPressed[KEY_E] = true;
+  if (game.currentScreen == SCREEN_GAMEOVER)
+    headless.keyPressed[KEY_R] = true;
+
+  float bestDist = 1e9f;
+  for (const auto &e : game.enemies) {
+    if (!e.active)
+      continue;
+    float d = Vector3Distance(e.position, game.player.position);
+    if (d < bestDist) {
+      bestDist = d;
+      headless.aimPoint = e.position;
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  int frames = 3600;
+  uint64_t seed = 1;
+  const char *tracePath = nullptr; // Chrome trace output, PROFILE=1 only
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--frames") == 0)
+      frames = atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "--seed") == 0)
+      seed = strtoull(argv[i + 1], nullptr, 10);
+    else if (strcmp(argv[i], "--entities") == 0)
+      firstWaveEnemies = atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "--trace") == 0)
+      tracePath = argv[i + 1];
+  }
+
+  SeedRandom(seed);
+  jobSystem = std::make_unique<JobSystem>(JobSystem::DefaultWorkerCount());
+  InitGame();
+
+  double maxFrameMs = 0.0;
+  for (headless.frame = 0; headless.frame < frames; headless.frame++) {
+    PROFILE_FRAME();
+    HeadlessScriptInput(headless.frame);
+    auto start = std::chrono::steady_clock::now();
+    UpdateGame();
+    std::chrono::duration<double, std::milli> ms =
+        std::chrono::steady_clock::now() - start;
+    headless.systemMs[HS_UPDATE] += ms.count();
+    if (ms.count() > maxFrameMs)
+      maxFrameMs = ms.count();
+    if (game.currentScreen == SCREEN_VICTORY)
+      break;
+  }
+
+  int alive = 0;
+  for (const auto &e : game.enemies)
+    alive += e.active ? 1 : 0;
+  int ran = headless.frame > 0 ? headless.frame : 1;
+  printf("{\"game\":\"cursor\",\"frames\":%d,\"seed\":%llu,\"entities\":%d,"
+         "\"threads\":%d,\"maxFrameMs\":%.4f,\"systems\":{",
+         ran, (unsigned long long)seed, firstWaveEnemies,
+         jobSystem->ThreadCount(), maxFrameMs);
+  for (int i = 0; i < HS_COUNT; i++) {
+    printf("%s\"%s\":{\"totalMs\":%.4f,\"avgUs\":%.3f}", i ? "," : "",
+           HEADLESS_SYSTEM_NAMES[i], headless.systemMs[i],
+           headless.systemMs[i] * 1000.0 / ran);
+  }
+  printf("},\"state\":{\"wave\":%d,\"alive\":%d,\"score\":%d}}\n",
+         game.wave, alive, (int)game.score);
+  jobSystem.reset();
+#ifdef ENABLE_PROFILER
+  if (tracePath && !ProfileWriteTrace(tracePath))
+    fprintf(stderr, "could not write %s\n", tracePath);
+#else
+  (void)tracePath;
+#endif
+  return 0;
+}
+#endif
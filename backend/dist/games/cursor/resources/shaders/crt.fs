@@ -16,6 +16,15 @@ out vec4 finalColor;
 uniform vec2 resolution;
 uniform float time;
 uniform float aberration;
+uniform vec2 uvScale;       // Live corner of the dynamic-resolution target
+
+// Sample the live corner, clamped half a texel in so bilinear filtering never
+// pulls in the unused part of the texture
+vec4 scene(vec2 uv)
+{
+    vec2 limit = uvScale - 0.5 / vec2(textureSize(texture0, 0));
+    return texture(texture0, min(uv * uvScale, limit));
+}
 
 // Constants
 const float CURVATURE = 3.0;
@@ -32,15 +41,15 @@ vec2 uv_curve(vec2 uv)
 
 void main()
 {
-    vec2 uv = uv_curve(fragTexCoord);
+    vec2 uv = uv_curve(fragTexCoord / uvScale);
     
     // Discard outside pixels
     if (uv.x < 0.0 || uv.x > 1.0 || uv.y < 0.0 || uv.y > 1.0) discard;
     
     // Chromatic Aberration
-    float r = texture(texture0, uv + vec2(aberration, 0.0)).r;
-    float g = texture(texture0, uv).g;
-    float b = texture(texture0, uv - vec2(aberration, 0.0)).b;
+    float r = scene(uv + vec2(aberration, 0.0)).r;
+    float g = scene(uv).g;
+    float b = scene(uv - vec2(aberration, 0.0)).b;
     vec3 color = vec3(r, g, b);
     
     // Scanlines
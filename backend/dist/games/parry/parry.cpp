@@ -10,8 +10,60 @@
 #include <string>
 #include <cmath>
 #include <algorithm>
-#include <random>
-#include <set>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+// ======================================================================
+// Headless Build (make headless)
+// ======================================================================
+// Compiled with -DHEADLESS, no window or GL context is created. Input and
+// clock queries are redirected to a scripted state driven by the headless
+// main(), which steps the game for N frames and prints timings as JSON.
+#ifdef HEADLESS
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+enum HeadlessSystem { HS_UPDATE, HS_ENEMIES, HS_COLLISION, HS_PARTICLES, HS_COUNT };
+const char* const HEADLESS_SYSTEM_NAMES[HS_COUNT] = {"update", "enemies", "collision", "particles"};
+
+struct HeadlessState {
+    int frame = 0;
+    float frameTime = 1.0f / 60.0f;
+    bool keyDown[512] = {};
+    bool keyPressed[512] = {};
+    bool mouseDown[8] = {};
+    Vector3 aimPoint {0,0,0};
+    double systemMs[HS_COUNT] = {};
+};
+HeadlessState headless;
+
+// Accumulates the lifetime of the enclosing block into one system slot
+struct HeadlessScope {
+    HeadlessSystem system;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ~HeadlessScope() {
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        headless.systemMs[system] += ms.count();
+    }
+};
+
+#define HEADLESS_CONCAT_(a, b) a##b
+#define HEADLESS_CONCAT(a, b) HEADLESS_CONCAT_(a, b)
+#define HEADLESS_SCOPE(system) HeadlessScope HEADLESS_CONCAT(headlessScope, __LINE__){system}
+
+#define IsKeyDown(key) (headless.keyDown[(key) & 511])
+#define IsKeyPressed(key) (headless.keyPressed[(key) & 511])
+#define IsMouseButtonDown(button) (headless.mouseDown[(button) & 7])
+#define IsMouseButtonPressed(button) false
+#define GetMouseRay(position, cam) (Ray{Vector3Add(headless.aimPoint, {0, 50.0f, 0}), {0, -1.0f, 0}})
+#define GetFrameTime() (headless.frameTime)
+#define GetTime() ((double)headless.frame * headless.frameTime)
+#else
+#define HEADLESS_SCOPE(system)
+#endif
 
 const int SCREEN_WIDTH = 1440;
 const int SCREEN_HEIGHT = 810;
@@ -41,11 +93,202 @@ const float CAMERA_SMOOTH = 12.0f;
 
 const float BULLET_LIFETIME = 5.5f;
 const float BULLET_SIZE = 0.65f;
+const int MAX_PARTICLES = 4096;
+const int PARTICLE_SPAWN_BUDGET = 256;  // New particles per frame
 const float PERFECT_PARRY_BONUS = 2.8f;
+const float BULLET_CULL_RADIUS = 120.0f;
+const float BULLET_GRID_CELL = 4.0f;
+const int BULLET_GRID_DIM = 60;  // Spans the cull radius on both axes
+const int BULLET_GRID_CELLS = BULLET_GRID_DIM * BULLET_GRID_DIM;
 
 const int UPGRADE_COST_BASE = 300;
 const int UPGRADE_COST_MULTIPLIER = 180;
 
+// ======================================================================
+// Deterministic RNG
+// ======================================================================
+// SplitMix-style counter RNG. A stream is just a key (mixed from the session
+// seed, a stream kind and an id) plus a counter, so streams are independent
+// and cheap to open anywhere. `rng` carries gameplay draws; `fxRng` carries
+// camera shake, particles and UI picks, which may run a different number of
+// times per frame without desyncing a seeded replay.
+enum RngStreamKind : uint64_t { RNG_SESSION, RNG_FX, RNG_WAVE };
+
+uint64_t rngSeed = 1;
+
+constexpr uint64_t Mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+struct Rng {
+    uint64_t key = 0;
+    uint64_t counter = 0;
+
+    static Rng Stream(RngStreamKind kind, uint64_t id = 0, uint64_t tick = 0) {
+        uint64_t k = Mix64(rngSeed ^ Mix64((uint64_t)kind * 0x9E3779B97F4A7C15ull + id));
+        return {Mix64(k ^ (tick * 0xD1B54A32D192ED03ull)), 0};
+    }
+
+    uint64_t Next() { return Mix64(key + ++counter * 0x9E3779B97F4A7C15ull); }
+
+    // Inclusive on both ends, like GetRandomValue()
+    int Range(int min, int max) {
+        if (max < min) std::swap(min, max);
+        uint64_t span = (uint64_t)((int64_t)max - min) + 1;
+        return min + (int)(((Next() >> 32) * span) >> 32);
+    }
+
+    float Float(float min, float max) { return min + (max - min) * (float)(Next() >> 40) * 0x1p-24f; }
+};
+
+Rng rng;
+Rng fxRng;
+
+void SeedRandom(uint64_t seed) {
+    rngSeed = seed;
+    rng = Rng::Stream(RNG_SESSION);
+    fxRng = Rng::Stream(RNG_FX);
+}
+
+// ======================================================================
+// Frame Profiler (make PROFILE=1)
+// ======================================================================
+// Same zone profiler as ashes.cpp. With -DENABLE_PROFILER each
+// PROFILE_ZONE("name") records its block's start/end into a ring of events
+// and PROFILE_FRAME() delimits rendered frames. F4 shows the last frames as
+// nested bars, F5 saves profile.json in Chrome Trace Event format. Release
+// builds compile every PROFILE_* macro away.
+#ifdef ENABLE_PROFILER
+#include <chrono>
+#include <cstdio>
+
+const int PROFILE_RING_SIZE = 8192;      // Power of two
+const int PROFILE_OVERLAY_FRAMES = 3;
+const int PROFILE_MAX_DEPTH = 6;         // Deeper zones are recorded, not drawn
+const char* const PROFILE_TRACE_PATH = "profile.json";
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t endNs;
+    int depth;
+};
+
+// Everything runs on the main thread, so a single ring with a plain head
+// suffices; zones are written as they close, overwriting the oldest.
+struct Profiler {
+    ProfileEvent events[PROFILE_RING_SIZE];
+    uint64_t head = 0;
+    int depth = 1;  // Depth 0 is the frame itself
+    uint64_t frameStartNs[PROFILE_OVERLAY_FRAMES + 1] = {};
+    uint64_t frameCount = 0;
+    bool showOverlay = false;
+
+    static uint64_t Now() {
+        static const auto epoch = std::chrono::steady_clock::now();
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void Push(const char* name, uint64_t startNs, uint64_t endNs, int eventDepth) {
+        events[head & (PROFILE_RING_SIZE - 1)] = {name, startNs, endNs, eventDepth};
+        head++;
+    }
+
+    uint64_t Oldest() const { return head > PROFILE_RING_SIZE ? head - PROFILE_RING_SIZE : 0; }
+};
+Profiler profiler;
+
+struct ProfileZone {
+    const char* name;
+    uint64_t start;
+    int depth;
+    explicit ProfileZone(const char* zoneName)
+        : name(zoneName), start(Profiler::Now()), depth(profiler.depth++) {}
+    ~ProfileZone() {
+        profiler.depth--;
+        profiler.Push(name, start, Profiler::Now(), depth);
+    }
+};
+
+bool ProfileWriteTrace(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\"traceEvents\":[");
+    for (uint64_t i = profiler.Oldest(); i < profiler.head; i++) {
+        const ProfileEvent& ev = profiler.events[i & (PROFILE_RING_SIZE - 1)];
+        fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":0}",
+                i > profiler.Oldest() ? "," : "", ev.name, ev.startNs / 1000.0,
+                (ev.endNs - ev.startNs) / 1000.0);
+    }
+    fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+    return true;
+}
+
+// Closes the previous frame as a depth-0 event and handles the hotkeys
+void ProfileFrameMark() {
+    uint64_t now = Profiler::Now();
+    if (profiler.frameCount > 0) {
+        profiler.Push("Frame", profiler.frameStartNs[PROFILE_OVERLAY_FRAMES], now, 0);
+    }
+    for (int i = 0; i < PROFILE_OVERLAY_FRAMES; i++) profiler.frameStartNs[i] = profiler.frameStartNs[i + 1];
+    profiler.frameStartNs[PROFILE_OVERLAY_FRAMES] = now;
+    profiler.frameCount++;
+
+    if (IsKeyPressed(KEY_F4)) profiler.showOverlay = !profiler.showOverlay;
+    if (IsKeyPressed(KEY_F5)) {
+        bool ok = ProfileWriteTrace(PROFILE_TRACE_PATH);
+        TraceLog(ok ? LOG_INFO : LOG_WARNING, "PROFILER: %s %s", ok ? "wrote" : "could not write", PROFILE_TRACE_PATH);
+    }
+}
+
+// Timeline of the last completed frames: one bar row per nesting depth,
+// frame boundaries as vertical lines
+void ProfileDrawOverlay() {
+    uint64_t begin = profiler.frameStartNs[0], end = profiler.frameStartNs[PROFILE_OVERLAY_FRAMES];
+    if (!profiler.showOverlay || begin == 0) return;
+    const int rowH = 16, x0 = 20, width = SCREEN_WIDTH - 40;
+    const int y0 = SCREEN_HEIGHT - 20 - rowH * PROFILE_MAX_DEPTH;
+    const float pxPerNs = (float)width / (float)(end - begin);
+
+    DrawRectangle(x0 - 6, y0 - 26, width + 12, rowH * PROFILE_MAX_DEPTH + 32, Fade(BLACK, 0.75f));
+    DrawText(TextFormat("PROFILER  %d FRAMES  AVG %.2f MS", PROFILE_OVERLAY_FRAMES,
+                        (end - begin) / 1e6 / PROFILE_OVERLAY_FRAMES), x0, y0 - 22, 16, LIME);
+    for (int f = 0; f <= PROFILE_OVERLAY_FRAMES; f++) {
+        int fx = x0 + (int)((profiler.frameStartNs[f] - begin) * pxPerNs);
+        DrawLine(fx, y0, fx, y0 + rowH * PROFILE_MAX_DEPTH, Fade(RED, 0.6f));
+    }
+
+    for (uint64_t i = profiler.head; i-- > profiler.Oldest(); ) {
+        const ProfileEvent& ev = profiler.events[i & (PROFILE_RING_SIZE - 1)];
+        if (ev.endNs < begin) break;  // Events are stored in end order
+        if (ev.startNs >= end || ev.depth >= PROFILE_MAX_DEPTH) continue;
+        uint64_t s = std::max(ev.startNs, begin), e = std::min(ev.endNs, end);
+        int bx = x0 + (int)((s - begin) * pxPerNs);
+        int bw = std::max(1, (int)((e - s) * pxPerNs));
+        int by = y0 + ev.depth * rowH;
+        unsigned hash = (unsigned)((uintptr_t)ev.name * 2654435761u);
+        DrawRectangle(bx, by, bw, rowH - 2, ColorFromHSV((float)(hash % 360), 0.55f, 0.85f));
+        if (bw > 70) {
+            DrawText(TextFormat("%s %.2f", ev.name, (ev.endNs - ev.startNs) / 1e6), bx + 2, by + 2, 10, BLACK);
+        }
+    }
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__){name}
+#define PROFILE_FRAME() ProfileFrameMark()
+#define PROFILE_OVERLAY() ProfileDrawOverlay()
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_FRAME()
+#define PROFILE_OVERLAY()
+#endif
+
 // ======================================================================
 // Enums & Structs
 // ======================================================================
@@ -59,6 +302,54 @@ struct Bullet {
     float life;
     bool playerBullet = false;
     bool reflected = false;
+    bool dead = false;  // Marked during UpdateBullets, compacted at its end
+};
+
+// Collision broadphase: a uniform XZ grid rebuilt each frame by counting sort.
+// Bullet indices for cell c are items[cellStart[c] .. cellStart[c + 1]).
+// Positions outside the grid clamp to the border cells, so queries stay exact.
+struct BulletGrid {
+    int cellStart[BULLET_GRID_CELLS + 1];
+    std::vector<int> items;
+
+    static int CellCoord(float v) {
+        int c = (int)floorf(v / BULLET_GRID_CELL) + BULLET_GRID_DIM / 2;
+        return std::clamp(c, 0, BULLET_GRID_DIM - 1);
+    }
+    static int CellOf(Vector3 p) { return CellCoord(p.z) * BULLET_GRID_DIM + CellCoord(p.x); }
+
+    // Buckets the live bullets owned by the player (or by enemies)
+    void Build(const std::vector<Bullet>& list, bool playerOwned) {
+        std::fill(cellStart, cellStart + BULLET_GRID_CELLS + 1, 0);
+        for (const Bullet& b : list) {
+            if (!b.dead && b.playerBullet == playerOwned) cellStart[CellOf(b.pos)]++;
+        }
+        int total = 0;
+        for (int c = 0; c < BULLET_GRID_CELLS; ++c) {
+            total += cellStart[c];
+            cellStart[c] = total;
+        }
+        cellStart[BULLET_GRID_CELLS] = total;
+        items.resize(total);
+        // Filling backwards leaves cellStart[c] at the cell's first slot
+        for (int i = (int)list.size() - 1; i >= 0; --i) {
+            const Bullet& b = list[i];
+            if (!b.dead && b.playerBullet == playerOwned) items[--cellStart[CellOf(b.pos)]] = i;
+        }
+    }
+
+    // Calls fn(index) for every bucketed bullet in the cells overlapping the circle
+    template <typename Fn>
+    void Query(Vector3 center, float radius, Fn&& fn) const {
+        int x0 = CellCoord(center.x - radius), x1 = CellCoord(center.x + radius);
+        int z0 = CellCoord(center.z - radius), z1 = CellCoord(center.z + radius);
+        for (int z = z0; z <= z1; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                int c = z * BULLET_GRID_DIM + x;
+                for (int k = cellStart[c]; k < cellStart[c + 1]; ++k) fn(items[k]);
+            }
+        }
+    }
 };
 
 struct Particle {
@@ -70,6 +361,34 @@ struct Particle {
     float size;
 };
 
+// Fixed-capacity particle storage. Live particles are packed at the front,
+// removal swaps the last live particle into the hole (order is not kept).
+// Spawn() returns nullptr once the pool or this frame's budget is exhausted.
+struct ParticlePool {
+    Particle items[MAX_PARTICLES];
+    int count = 0;
+    int spawnedThisFrame = 0;
+    int peakCount = 0;
+    int dropped = 0;
+
+    Particle* Spawn() {
+        if (count >= MAX_PARTICLES || spawnedThisFrame >= PARTICLE_SPAWN_BUDGET) {
+            dropped++;
+            return nullptr;
+        }
+        spawnedThisFrame++;
+        Particle* p = &items[count++];
+        *p = {};
+        peakCount = std::max(peakCount, count);
+        return p;
+    }
+    void Kill(int i) { items[i] = items[--count]; }
+    void BeginFrame() { spawnedThisFrame = 0; }
+    void Clear() { count = 0; spawnedThisFrame = 0; }
+    const Particle* begin() const { return items; }
+    const Particle* end() const { return items + count; }
+};
+
 struct SoulOrb {
     Vector3 pos;
     float timer;
@@ -126,15 +445,19 @@ int wave = 1;
 Player player;
 std::vector<Enemy> enemies;
 std::vector<Bullet> bullets;
-std::vector<Particle> particles;
+BulletGrid playerBulletGrid;
+BulletGrid enemyBulletGrid;
+ParticlePool particles;
 std::vector<SoulOrb> soulOrbs;
 Camera3D camera = {0};
 float hitStop = 0.0f;
+bool showDebugOverlay = false;
 int totalEnemyBullets = 0;
 int neutralized = 0;
 float accuracy = 0.0f;
 
 Vector3 bonfirePos = {0, 0, 0};
+int waveOneGruntCount = 10;
 
 std::vector<std::string> deathQuotes = {
     "Bullet Issue", "Git Gud @ Dodging", "Parry Failed", "Souls Lost Forever",
@@ -142,11 +465,159 @@ std::vector<std::string> deathQuotes = {
     "Combo Lost", "Bonfire Denied", "Humanity Drained", "You Died... Again"
 };
 
+// ======================================================================
+// Instanced Renderer
+// ======================================================================
+// Particles (and other swarms of identical primitives) are drawn as
+// instances of one low-poly unit mesh. Each DrawInstance() appends
+// {center, size, colour} to a CPU buffer; FlushInstances() uploads it and
+// issues a single instanced draw, instead of one tessellated immediate-mode
+// DrawSphere per particle. Without a usable shader or VAO (or in the
+// HEADLESS build) DrawInstance() falls back to the immediate-mode call.
+const int MAX_INSTANCES = 4096;
+const int INSTANCE_ATTRIB_CENTER = 12;  // Must match the layout() in the shader
+const int INSTANCE_ATTRIB_COLOR = 13;
+
+#ifdef __EMSCRIPTEN__
+#define INSTANCE_GLSL_VERSION "#version 300 es\nprecision mediump float;\n"
+#else
+#define INSTANCE_GLSL_VERSION "#version 330\n"
+#endif
+
+const char* const INSTANCE_VS = INSTANCE_GLSL_VERSION R"(
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 12) in vec4 instanceCenter;  // xyz = center, w = size
+layout(location = 13) in vec4 instanceColor;
+uniform mat4 mvp;
+out vec4 fragColor;
+void main() {
+    fragColor = instanceColor;
+    gl_Position = mvp * vec4(instanceCenter.xyz + vertexPosition * instanceCenter.w, 1.0);
+}
+)";
+
+const char* const INSTANCE_FS = INSTANCE_GLSL_VERSION R"(
+in vec4 fragColor;
+out vec4 finalColor;
+void main() { finalColor = fragColor; }
+)";
+
+struct InstanceData {
+    float x, y, z, size;
+    unsigned char r, g, b, a;
+};
+
+enum InstanceShape { INSTANCE_SPHERE, INSTANCE_CUBE };
+
+struct InstanceBatch {
+    InstanceShape shape = INSTANCE_SPHERE;
+    unsigned int vao = 0;
+    unsigned int meshVbo = 0;
+    unsigned int indexVbo = 0;
+    unsigned int instanceVbo = 0;
+    int vertexCount = 0;
+    int indexCount = 0;
+    bool ready = false;
+    int count = 0;
+    InstanceData instances[MAX_INSTANCES];
+};
+
+Shader instanceShader = {0};
+int instanceMvpLoc = -1;
+int instanceDrawCalls = 0;  // Since ResetInstanceStats(), for the debug overlay
+int instancesDrawn = 0;
+InstanceBatch sphereBatch;
+
+// Unit mesh: sphere of radius 1 or cube of edge 1, matching DrawSphere/DrawCube sizes
+void InitInstanceBatch(InstanceBatch& batch, InstanceShape shape) {
+    batch.shape = shape;
+    if (instanceShader.id == 0) {
+        instanceShader = LoadShaderFromMemory(INSTANCE_VS, INSTANCE_FS);
+        instanceMvpLoc = GetShaderLocation(instanceShader, "mvp");
+    }
+    if (instanceShader.id == rlGetShaderIdDefault()) return;  // Compile failed
+
+    Mesh mesh = (shape == INSTANCE_SPHERE) ? GenMeshSphere(1.0f, 8, 10) : GenMeshCube(1.0f, 1.0f, 1.0f);
+    batch.vao = rlLoadVertexArray();
+    if (batch.vao == 0) {
+        UnloadMesh(mesh);
+        return;
+    }
+    rlEnableVertexArray(batch.vao);
+    batch.vertexCount = mesh.vertexCount;
+    batch.meshVbo = rlLoadVertexBuffer(mesh.vertices, mesh.vertexCount * 3 * sizeof(float), false);
+    rlSetVertexAttribute(0, 3, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(0);
+    if (mesh.indices) {
+        batch.indexCount = mesh.triangleCount * 3;
+        batch.indexVbo = rlLoadVertexBufferElement(mesh.indices, batch.indexCount * sizeof(unsigned short), false);
+    }
+
+    batch.instanceVbo = rlLoadVertexBuffer(nullptr, sizeof(batch.instances), true);
+    rlSetVertexAttribute(INSTANCE_ATTRIB_CENTER, 4, RL_FLOAT, false, sizeof(InstanceData), 0);
+    rlEnableVertexAttribute(INSTANCE_ATTRIB_CENTER);
+    rlSetVertexAttributeDivisor(INSTANCE_ATTRIB_CENTER, 1);
+    rlSetVertexAttribute(INSTANCE_ATTRIB_COLOR, 4, RL_UNSIGNED_BYTE, true, sizeof(InstanceData),
+                         offsetof(InstanceData, r));
+    rlEnableVertexAttribute(INSTANCE_ATTRIB_COLOR);
+    rlSetVertexAttributeDivisor(INSTANCE_ATTRIB_COLOR, 1);
+    rlDisableVertexArray();
+
+    UnloadMesh(mesh);
+    batch.ready = true;
+}
+
+void UnloadInstanceBatch(InstanceBatch& batch) {
+    if (!batch.ready) return;
+    rlUnloadVertexArray(batch.vao);
+    rlUnloadVertexBuffer(batch.meshVbo);
+    if (batch.indexVbo) rlUnloadVertexBuffer(batch.indexVbo);
+    rlUnloadVertexBuffer(batch.instanceVbo);
+    batch.ready = false;
+}
+
+void FlushInstances(InstanceBatch& batch) {
+    if (batch.count == 0) return;
+    rlDrawRenderBatchActive();  // Keep draw order with the immediate-mode geometry
+
+    Matrix modelView = MatrixMultiply(rlGetMatrixTransform(), rlGetMatrixModelview());
+    rlEnableShader(instanceShader.id);
+    rlSetUniformMatrix(instanceMvpLoc, MatrixMultiply(modelView, rlGetMatrixProjection()));
+    rlEnableVertexArray(batch.vao);
+    rlUpdateVertexBuffer(batch.instanceVbo, batch.instances, batch.count * sizeof(InstanceData), 0);
+    if (batch.indexVbo) rlDrawVertexArrayElementsInstanced(0, batch.indexCount, 0, batch.count);
+    else rlDrawVertexArrayInstanced(0, batch.vertexCount, batch.count);
+    rlDisableVertexArray();
+    rlDisableShader();
+
+    instanceDrawCalls++;
+    instancesDrawn += batch.count;
+    batch.count = 0;
+}
+
+void DrawInstance(InstanceBatch& batch, Vector3 center, float size, Color color) {
+    if (!batch.ready) {
+        if (batch.shape == INSTANCE_SPHERE) DrawSphere(center, size, color);
+        else DrawCube(center, size, size, size, color);
+        return;
+    }
+    if (batch.count == MAX_INSTANCES) FlushInstances(batch);
+    batch.instances[batch.count++] = {center.x, center.y, center.z, size,
+                                      color.r, color.g, color.b, color.a};
+}
+
+void ResetInstanceStats() {
+    instanceDrawCalls = 0;
+    instancesDrawn = 0;
+}
+
 // ======================================================================
 // Functions
 // ======================================================================
 void InitGame();
 void ResetWave(bool fullReset = false);
+void UpdateFrame(float dt);
+void DrawFrame();
 void UpdateGame(float dt);
 void UpdatePlayer(float dt);
 void UpdateEnemies(float dt);
@@ -170,9 +641,185 @@ void DrawDeath();
 void DrawVictory();
 Vector3 GetAimPoint();
 
+// ======================================================================
+// Live Stats API
+// ======================================================================
+// game_get_stats() is exported to the page (Module._game_get_stats) and
+// hands back a GameStats in the wasm heap; the shell reads it as 32-bit
+// words. Same layout as ashes.cpp and cursor.cpp so one panel serves every
+// game: keep it in sync with STATS_FIELDS in game_shell.html and
+// wasm_loader.html, and bump STATS_VERSION on change. Polling happens
+// between frames on the browser main thread, which also runs the game loop.
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+
+const int STATS_VERSION = 2;
+const int STATS_HISTORY = 240;  // Frame times behind the percentiles (~4 s)
+
+// Parry has no effect queue; those two counters stay 0
+struct GameStats {
+    uint32_t version;
+    uint32_t frames;
+    float frameMsP50, frameMsP95, frameMsP99, frameMsMax;
+    float simMs, drawMs;  // Last frame
+    int32_t liveEnemies, liveBullets, liveParticles;
+    int32_t peakEnemies, peakBullets, peakParticles;  // Session high-water marks
+    int32_t effectQueueDepth, effectQueuePeak;
+    int32_t qualityTier;  // Index into QUALITY_TIERS, 0 = HIGH
+};
+
+struct StatsRecorder {
+    GameStats out = {};
+    float frameMs[STATS_HISTORY] = {};
+    double frameStart = 0.0;
+    double markTime = 0.0;
+};
+StatsRecorder stats;
+
+// Top of each rendered frame: closes the previous frame's wall time
+void StatsBeginFrame() {
+    double now = GetTime();
+    if (stats.frameStart > 0.0) {
+        stats.frameMs[stats.out.frames % STATS_HISTORY] = (float)((now - stats.frameStart) * 1000.0);
+        stats.out.frames++;
+    }
+    stats.frameStart = stats.markTime = now;
+}
+
+// Milliseconds since the last begin/lap
+float StatsLap() {
+    double now = GetTime();
+    float ms = (float)((now - stats.markTime) * 1000.0);
+    stats.markTime = now;
+    return ms;
+}
+
+void StatsEndSim() { stats.out.simMs = StatsLap(); }
+
+void StatsEndDraw() {
+    stats.out.drawMs = StatsLap();
+    int alive = 0;
+    for (const auto& e : enemies) if (e.alive) alive++;
+    stats.out.liveEnemies = alive;
+    stats.out.liveBullets = (int)bullets.size();
+    stats.out.liveParticles = particles.count;
+    stats.out.peakEnemies = std::max(stats.out.peakEnemies, alive);
+    stats.out.peakBullets = std::max(stats.out.peakBullets, stats.out.liveBullets);
+    stats.out.peakParticles = particles.peakCount;
+}
+
+// ======================================================================
+// Quality Governor
+// ======================================================================
+// Boss waves can push a weak GPU well under 60 fps. Parry updates with the
+// raw frame time, so every slow frame is a longer dt: bullets and dashes
+// jump further per update and hits get coarser. Most of that frame cost is
+// particles and bonfire flames, which are what the tiers cut. The governor
+// watches the mean wall frame time over a rolling window and steps down a
+// tier as soon as it crosses QUALITY_DEGRADE_MS; stepping back up needs the
+// mean to sit below the lower QUALITY_UPGRADE_MS for upgradeHold seconds.
+// If an upgrade is undone within QUALITY_REVERT_WINDOW, upgradeHold doubles
+// so borderline machines stop oscillating. Tiers scale particles, bonfire
+// flames and sphere tessellation only; bullets, enemies and collisions are
+// identical on every tier.
+struct QualityTier {
+    const char* name;
+    float particleScale;            // Multiplies SpawnParticles counts
+    int bonfireFlames;              // Flame spheres ringing the bonfire
+    int sphereRings, sphereSlices;  // Actor spheres (raylib's DrawSphere is 16x16)
+};
+
+const QualityTier QUALITY_TIERS[] = {
+    {"HIGH",   1.00f, 25, 16, 16},
+    {"MEDIUM", 0.60f, 16, 10, 12},
+    {"LOW",    0.30f, 10,  6,  8},
+};
+const int QUALITY_TIER_COUNT = sizeof(QUALITY_TIERS) / sizeof(QUALITY_TIERS[0]);
+const int QUALITY_WINDOW = 90;                // Frames in the rolling mean (~1.5 s)
+const float QUALITY_DEGRADE_MS = 19.0f;       // ~52 fps
+const float QUALITY_UPGRADE_MS = 17.5f;       // ~57 fps
+const float QUALITY_SAMPLE_CAP_MS = 100.0f;   // Tab switches and GC pauses count as one slow frame
+const float QUALITY_UPGRADE_HOLD = 4.0f;
+const float QUALITY_UPGRADE_HOLD_MAX = 64.0f;
+const float QUALITY_REVERT_WINDOW = 10.0f;
+
+struct QualityGovernor {
+    float samples[QUALITY_WINDOW] = {};
+    float sum = 0.0f;
+    int count = 0;
+    int head = 0;
+    int tier = 0;
+    float calm = 0.0f;          // Seconds spent under QUALITY_UPGRADE_MS
+    float sinceChange = 0.0f;
+    bool lastWasUpgrade = false;
+    float upgradeHold = QUALITY_UPGRADE_HOLD;
+};
+QualityGovernor quality;
+
+const QualityTier& Quality() { return QUALITY_TIERS[quality.tier]; }
+
+int QualityParticles(int count) {
+    return std::max(1, (int)(count * Quality().particleScale + 0.5f));
+}
+
+void QualitySetTier(int tier) {
+    quality.lastWasUpgrade = tier < quality.tier;
+    quality.tier = tier;
+    quality.count = quality.head = 0;   // Fresh window for the new tier
+    quality.sum = quality.calm = quality.sinceChange = 0.0f;
+    TraceLog(LOG_INFO, "Quality tier: %s", Quality().name);
+}
+
+void QualityObserve(float frameMs) {
+    float ms = std::min(frameMs, QUALITY_SAMPLE_CAP_MS);
+    if (quality.count == QUALITY_WINDOW) quality.sum -= quality.samples[quality.head];
+    else quality.count++;
+    quality.samples[quality.head] = ms;
+    quality.sum += ms;
+    quality.head = (quality.head + 1) % QUALITY_WINDOW;
+    quality.sinceChange += ms / 1000.0f;
+    if (quality.count < QUALITY_WINDOW) return;
+
+    float mean = quality.sum / quality.count;
+    if (mean > QUALITY_DEGRADE_MS) {
+        if (quality.tier == QUALITY_TIER_COUNT - 1) return;
+        if (quality.lastWasUpgrade && quality.sinceChange < QUALITY_REVERT_WINDOW)
+            quality.upgradeHold = std::min(quality.upgradeHold * 2.0f, QUALITY_UPGRADE_HOLD_MAX);
+        QualitySetTier(quality.tier + 1);
+    } else if (mean < QUALITY_UPGRADE_MS && quality.tier > 0) {
+        quality.calm += ms / 1000.0f;
+        if (quality.calm >= quality.upgradeHold) QualitySetTier(quality.tier - 1);
+    } else {
+        quality.calm = 0.0f;
+    }
+}
+
+void DrawQualitySphere(Vector3 center, float radius, Color color) {
+    DrawSphereEx(center, radius, Quality().sphereRings, Quality().sphereSlices, color);
+}
+
+extern "C" EMSCRIPTEN_KEEPALIVE const GameStats* game_get_stats() {
+    int n = std::min<int>(stats.out.frames, STATS_HISTORY);
+    float sorted[STATS_HISTORY];
+    std::copy(stats.frameMs, stats.frameMs + n, sorted);
+    std::sort(sorted, sorted + n);
+    auto pct = [&](float p) { return n ? sorted[std::min(n - 1, (int)(p * n))] : 0.0f; };
+    stats.out.version = STATS_VERSION;
+    stats.out.frameMsP50 = pct(0.50f);
+    stats.out.frameMsP95 = pct(0.95f);
+    stats.out.frameMsP99 = pct(0.99f);
+    stats.out.frameMsMax = n ? sorted[n - 1] : 0.0f;
+    stats.out.qualityTier = quality.tier;
+    return &stats.out;
+}
+
 // ======================================================================
 // Main
 // ======================================================================
+#ifndef HEADLESS
 int main() {
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Parry the Storm – Ashes of the Bullet (Dark Souls Edition)");
 
@@ -181,83 +828,110 @@ int main() {
     SetTargetFPS(60);
     HideCursor();
     InitAudioDevice();
+    InitInstanceBatch(sphereBatch, INSTANCE_SPHERE);
+    SeedRandom((uint64_t)time(nullptr));
+    TraceLog(LOG_INFO, "RNG seed: %llu", (unsigned long long)rngSeed);
     InitGame();
 
     while (!WindowShouldClose()) {
-        float dt = GetFrameTime();
-        if (hitStop > 0.0f) {
-            hitStop -= dt;
-            dt = 0.0f;
-        }
+        PROFILE_FRAME();
+        StatsBeginFrame();
+        QualityObserve(GetFrameTime() * 1000.0f);
+        UpdateFrame(GetFrameTime());
+        StatsEndSim();
+        DrawFrame();
+        StatsEndDraw();
+    }
 
-        if (state == TITLE) {
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) || IsKeyPressed(KEY_ENTER)) {
-                wave = 1;
-                state = PLAYING;
-                ResetWave();
+    UnloadInstanceBatch(sphereBatch);
+    UnloadShader(instanceShader);
+    CloseWindow();
+    return 0;
+}
+#endif
+
+void UpdateFrame(float dt) {
+    PROFILE_ZONE("UpdateFrame");
+    if (IsKeyPressed(KEY_F3)) showDebugOverlay = !showDebugOverlay;
+
+    if (hitStop > 0.0f) {
+        hitStop -= dt;
+        dt = 0.0f;
+    }
+
+    if (state == TITLE) {
+        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) || IsKeyPressed(KEY_ENTER)) {
+            wave = 1;
+            state = PLAYING;
+            ResetWave();
+        }
+    } else if (state == PLAYING || state == PAUSED || state == BONFIRE) {
+        if (IsKeyPressed(KEY_ESCAPE)) {
+            state = (state == PLAYING || state == BONFIRE) ? PAUSED : PLAYING;
+        }
+        if (state == PLAYING) {
+            UpdateGame(dt);
+        } else if (state == BONFIRE) {
+            if (IsKeyPressed(KEY_ONE) && player.souls >= GetUpgradeCost(player.vitality)) {
+                player.souls -= GetUpgradeCost(player.vitality++);
+                player.maxHealth += 12;
+                player.health = player.maxHealth;
             }
-        } else if (state == PLAYING || state == PAUSED || state == BONFIRE) {
-            if (IsKeyPressed(KEY_ESCAPE)) {
-                state = (state == PLAYING || state == BONFIRE) ? PAUSED : PLAYING;
+            if (IsKeyPressed(KEY_TWO) && player.souls >= GetUpgradeCost(player.endurance)) {
+                player.souls -= GetUpgradeCost(player.endurance++);
+                player.maxStamina += 15;
+                player.stamina = player.maxStamina;
             }
-            if (state == PLAYING) {
-                UpdateGame(dt);
-            } else if (state == BONFIRE) {
-                if (IsKeyPressed(KEY_ONE) && player.souls >= GetUpgradeCost(player.vitality)) {
-                    player.souls -= GetUpgradeCost(player.vitality++);
-                    player.maxHealth += 12;
-                    player.health = player.maxHealth;
-                }
-                if (IsKeyPressed(KEY_TWO) && player.souls >= GetUpgradeCost(player.endurance)) {
-                    player.souls -= GetUpgradeCost(player.endurance++);
-                    player.maxStamina += 15;
-                    player.stamina = player.maxStamina;
-                }
-                if (IsKeyPressed(KEY_THREE) && player.souls >= GetUpgradeCost(player.strength)) {
-                    player.souls -= GetUpgradeCost(player.strength++);
-                    player.bulletSpeed += 5.0f;
-                }
-                if (IsKeyPressed(KEY_FOUR) && player.souls >= GetUpgradeCost(player.dexterity)) {
-                    player.souls -= GetUpgradeCost(player.dexterity++);
-                    player.shootRate *= 0.92f;
-                    player.parryWindow += 0.02f;
-                }
-                if (IsKeyPressed(KEY_SPACE)) {
-                    ResetWave();
-                    state = PLAYING;
-                }
+            if (IsKeyPressed(KEY_THREE) && player.souls >= GetUpgradeCost(player.strength)) {
+                player.souls -= GetUpgradeCost(player.strength++);
+                player.bulletSpeed += 5.0f;
+            }
+            if (IsKeyPressed(KEY_FOUR) && player.souls >= GetUpgradeCost(player.dexterity)) {
+                player.souls -= GetUpgradeCost(player.dexterity++);
+                player.shootRate *= 0.92f;
+                player.parryWindow += 0.02f;
             }
-        } else if (state == DEAD) {
-            if (IsKeyPressed(KEY_R)) {
-                wave = 1;
-                ResetWave(true);
+            if (IsKeyPressed(KEY_SPACE)) {
+                ResetWave();
                 state = PLAYING;
             }
         }
+    } else if (state == DEAD) {
+        if (IsKeyPressed(KEY_R)) {
+            wave = 1;
+            ResetWave(true);
+            state = PLAYING;
+        }
+    }
+}
 
-        BeginDrawing();
-        ClearBackground({8, 8, 18, 255});
+void DrawFrame() {
+    PROFILE_ZONE("DrawFrame");
+    ResetInstanceStats();
+    BeginDrawing();
+    ClearBackground({8, 8, 18, 255});
 
-        BeginMode3D(camera);
-        Draw3D();
-        EndMode3D();
+    BeginMode3D(camera);
+    Draw3D();
+    EndMode3D();
 
+    {
+        PROFILE_ZONE("DrawHUD");
         DrawCrosshairAndAimMarker();
         DrawHUD();
-        if (state == TITLE) DrawTitle();
-        if (state == DEAD) DrawDeath();
-        if (state == VICTORY) DrawVictory();
-        if (state == BONFIRE) DrawBonfireMenu();
-        if (state == PAUSED) {
-            DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, Fade(BLACK, 0.7f));
-            DrawText("PAUSED - GIT GUD", SCREEN_WIDTH/2 - MeasureText("PAUSED - GIT GUD", 80)/2, SCREEN_HEIGHT/2 - 40, 80, GOLD);
-        }
-
-        EndDrawing();
+    }
+    if (state == TITLE) DrawTitle();
+    if (state == DEAD) DrawDeath();
+    if (state == VICTORY) DrawVictory();
+    if (state == BONFIRE) DrawBonfireMenu();
+    if (state == PAUSED) {
+        DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, Fade(BLACK, 0.7f));
+        DrawText("PAUSED - GIT GUD", SCREEN_WIDTH/2 - MeasureText("PAUSED - GIT GUD", 80)/2, SCREEN_HEIGHT/2 - 40, 80, GOLD);
     }
 
-    CloseWindow();
-    return 0;
+    PROFILE_OVERLAY();
+    PROFILE_ZONE("EndDrawing");  // Buffer swap; absorbs GPU and vsync waits
+    EndDrawing();
 }
 
 void InitGame() {
@@ -288,13 +962,16 @@ void ResetWave(bool fullReset) {
 
     enemies.clear();
     bullets.clear();
-    particles.clear();
+    particles.Clear();
     soulOrbs.clear();
     totalEnemyBullets = 0;
     neutralized = 0;
     player.score = 0;
     player.combo = 0;
 
+    // Spawn ring jitter comes from the wave's own stream, so a seed always
+    // lays out the same waves however the previous one was played
+    Rng layout = Rng::Stream(RNG_WAVE, wave);
     auto spawnEnemy = [&](EnemyType t, int count, int hp, int souls) {
         for (int i = 0; i < count; i++) {
             Enemy e{};
@@ -302,7 +979,7 @@ void ResetWave(bool fullReset) {
             e.health = e.maxHealth = hp;
             e.soulValue = souls;
             e.shootTimer = (float)i * 0.25f;
-            float angle = (float)i / count * 2 * PI + GetRandomValue(-30,30) * DEG2RAD;
+            float angle = (float)i / count * 2 * PI + layout.Range(-30,30) * DEG2RAD;
             float radius = 55.0f;
             e.pos = {cosf(angle) * radius, 0, sinf(angle) * radius};
             e.color = (t == BOSS) ? MAROON : (t == SHIELDED) ? DARKGRAY : (t == RAPID) ? ORANGE : (t == SPIRAL) ? PURPLE : RED;
@@ -312,7 +989,7 @@ void ResetWave(bool fullReset) {
     };
 
     if (wave == 1) {
-        spawnEnemy(GRUNT, 10, 70, 80);
+        spawnEnemy(GRUNT, waveOneGruntCount, 70, 80);
     } else if (wave == 2) {
         spawnEnemy(GRUNT, 4, 90, 120);
         spawnEnemy(SPIRAL, 3, 60, 140);
@@ -339,7 +1016,7 @@ void DropSouls(Vector3 pos, int amount) {
     int orbs = amount / 80;
     for (int i = 0; i < orbs; i++) {
         SoulOrb s;
-        s.pos = Vector3Add(pos, {GetRandomValue(-60,60)/10.0f, 3.0f, GetRandomValue(-60,60)/10.0f});
+        s.pos = Vector3Add(pos, {rng.Range(-60,60)/10.0f, 3.0f, rng.Range(-60,60)/10.0f});
         s.timer = 10.0f;
         soulOrbs.push_back(s);
     }
@@ -371,6 +1048,7 @@ Vector3 GetAimPoint() {
 }
 
 void UpdatePlayer(float dt) {
+    PROFILE_ZONE("UpdatePlayer");
     player.hitInvuln = std::max(0.0f, player.hitInvuln - dt);
     player.shake = std::max(0.0f, player.shake - dt);
     player.shootCD = std::max(0.0f, player.shootCD - dt);
@@ -471,6 +1149,8 @@ void UpdatePlayer(float dt) {
 }
 
 void UpdateEnemies(float dt) {
+    HEADLESS_SCOPE(HS_ENEMIES);
+    PROFILE_ZONE("UpdateEnemies");
     for (auto& e : enemies) {
         if (!e.alive) continue;
 
@@ -572,71 +1252,71 @@ void SpawnBullet(Vector3 pos, Vector3 vel, Color col, bool playerOwned, bool ref
 }
 
 void SpawnParticles(Vector3 pos, Color col, int count, float speed) {
+    count = QualityParticles(count);
     for (int i = 0; i < count; i++) {
-        Particle p;
-        p.pos = pos;
-        Vector3 dir = {GetRandomValue(-100,100)/100.0f, GetRandomValue(30,100)/100.0f, GetRandomValue(-100,100)/100.0f};
-        p.vel = Vector3Scale(Vector3Normalize(dir), speed);
-        p.life = p.maxLife = GetRandomValue(30,80)/100.0f;
-        p.color = col;
-        p.size = GetRandomValue(4,12)/10.0f;
-        particles.push_back(p);
+        Particle* p = particles.Spawn();
+        if (!p) break;
+        p->pos = pos;
+        Vector3 dir = {fxRng.Range(-100,100)/100.0f, fxRng.Range(30,100)/100.0f, fxRng.Range(-100,100)/100.0f};
+        p->vel = Vector3Scale(Vector3Normalize(dir), speed);
+        p->life = p->maxLife = fxRng.Range(30,80)/100.0f;
+        p->color = col;
+        p->size = fxRng.Range(4,12)/10.0f;
     }
 }
 
 void UpdateParticles(float dt) {
-    for (auto it = particles.begin(); it != particles.end(); ) {
-        it->pos = Vector3Add(it->pos, Vector3Scale(it->vel, dt));
-        it->vel.y -= 20.0f * dt;
-        it->life -= dt;
-        if (it->life <= 0.0f) it = particles.erase(it);
-        else ++it;
+    HEADLESS_SCOPE(HS_PARTICLES);
+    PROFILE_ZONE("UpdateParticles");
+    for (int i = 0; i < particles.count; ) {
+        Particle& p = particles.items[i];
+        p.pos = Vector3Add(p.pos, Vector3Scale(p.vel, dt));
+        p.vel.y -= 20.0f * dt;
+        p.life -= dt;
+        if (p.life <= 0.0f) particles.Kill(i);  // Swapped-in particle is processed next
+        else i++;
     }
 }
 
 void UpdateCamera() {
+    PROFILE_ZONE("UpdateCamera");
     Vector3 desiredPos = Vector3Add(player.pos, {0, CAMERA_HEIGHT, CAMERA_DISTANCE});
     camera.position = Vector3Lerp(camera.position, desiredPos, CAMERA_SMOOTH * GetFrameTime());
     camera.target = Vector3Add(player.pos, {0, 3.0f, 0});
 
     if (player.shake > 0.0f) {
-        Vector3 shakeOffset = {GetRandomValue(-100,100)/100.0f * player.shake * 10,
-                               GetRandomValue(-100,100)/100.0f * player.shake * 10,
-                               GetRandomValue(-100,100)/100.0f * player.shake * 10};
+        Vector3 shakeOffset = {fxRng.Range(-100,100)/100.0f * player.shake * 10,
+                               fxRng.Range(-100,100)/100.0f * player.shake * 10,
+                               fxRng.Range(-100,100)/100.0f * player.shake * 10};
         camera.position = Vector3Add(camera.position, shakeOffset);
     }
 }
 
 void UpdateBullets(float dt) {
+    HEADLESS_SCOPE(HS_COLLISION);
+    PROFILE_ZONE("UpdateBullets");
     for (auto& b : bullets) {
         b.pos = Vector3Add(b.pos, Vector3Scale(b.vel, dt));
         b.life -= dt;
+        b.dead = b.life <= 0.0f || Vector3Length(b.pos) > BULLET_CULL_RADIUS;
     }
 
-    std::set<size_t> toRemove;
-
-    for (size_t i = 0; i < bullets.size(); ++i) {
-        const Bullet& b = bullets[i];
-
-        if (b.life <= 0.0f || Vector3Length(b.pos) > 120.0f) {
-            toRemove.insert(i);
-            continue;
-        }
-
-        if (!b.playerBullet && Vector3Distance(b.pos, player.pos) < 3.0f && player.hitInvuln <= 0.0f) {
+    for (auto& b : bullets) {
+        if (b.dead || b.playerBullet) continue;
+        if (Vector3Distance(b.pos, player.pos) < 3.0f && player.hitInvuln <= 0.0f) {
             player.health -= 12;
             player.hitInvuln = 0.6f;
             player.combo = 0;
             player.shake = 0.4f;
             hitStop = 0.06f;
             SpawnParticles(b.pos, RED, 25, 14.0f);
-            toRemove.insert(i);
+            b.dead = true;
         }
     }
 
-    for (size_t i = 0; i < bullets.size(); ++i) {
-        Bullet& b = bullets[i];
-        if (!b.playerBullet && player.isParrying && Vector3Distance(b.pos, player.pos) < PARRY_RANGE) {
+    for (auto& b : bullets) {
+        if (b.dead || b.playerBullet) continue;
+        if (player.isParrying && Vector3Distance(b.pos, player.pos) < PARRY_RANGE) {
             b.vel = Vector3Scale(Vector3Normalize(Vector3Negate(b.vel)), Vector3Length(b.vel) * PERFECT_PARRY_BONUS);
             b.playerBullet = true;
             b.reflected = true;
@@ -650,56 +1330,61 @@ void UpdateBullets(float dt) {
         }
     }
 
-    for (size_t i = 0; i < bullets.size(); ++i) {
-        if (!bullets[i].playerBullet) continue;
-        const Vector3& ppos = bullets[i].pos;
-
-        for (size_t j = 0; j < bullets.size(); ++j) {
-            if (bullets[j].playerBullet) continue;
-            if (Vector3Distance(ppos, bullets[j].pos) < BULLET_SIZE * 2) {
-                neutralized++;
-                player.combo++;
-                player.score += 15 * player.combo;
-                SpawnParticles(ppos, WHITE, 15, 12.0f);
-                toRemove.insert(i);
-                toRemove.insert(j);
-            }
-        }
+    // Both grids are built before any bullet-vs-bullet kills, so a player
+    // bullet that cancels an enemy shot this frame can still land on an enemy
+    playerBulletGrid.Build(bullets, true);
+    enemyBulletGrid.Build(bullets, false);
+
+    const float cancelRange = BULLET_SIZE * 2;
+    for (auto& pb : bullets) {
+        if (pb.dead || !pb.playerBullet) continue;
+        enemyBulletGrid.Query(pb.pos, cancelRange, [&](int j) {
+            Bullet& eb = bullets[j];
+            if (eb.dead || Vector3Distance(pb.pos, eb.pos) >= cancelRange) return;
+            neutralized++;
+            player.combo++;
+            player.score += 15 * player.combo;
+            SpawnParticles(pb.pos, WHITE, 15, 12.0f);
+            pb.dead = true;
+            eb.dead = true;
+        });
+    }
 
-        for (auto& e : enemies) {
-            if (!e.alive) continue;
-            Vector3 fromBulletToEnemy = Vector3Subtract(e.pos, ppos);
-            float dot = Vector3DotProduct(Vector3Normalize(fromBulletToEnemy), 
-                                         Vector3Normalize({sinf(e.rotation*DEG2RAD), 0, cosf(e.rotation*DEG2RAD)}));
+    for (auto& e : enemies) {
+        if (!e.alive) continue;
+        float hitRange = e.scale * 4.0f;
+        Vector3 facing = {sinf(e.rotation*DEG2RAD), 0, cosf(e.rotation*DEG2RAD)};
+        playerBulletGrid.Query(e.pos, hitRange, [&](int i) {
+            Bullet& b = bullets[i];
+            if (!e.alive || Vector3Distance(b.pos, e.pos) >= hitRange) return;
+            float dot = Vector3DotProduct(Vector3Normalize(Vector3Subtract(e.pos, b.pos)), facing);
             bool blocked = (e.type == SHIELDED && dot > 0.35f);
-            if (Vector3Distance(ppos, e.pos) < e.scale * 4.0f) {
-                if (blocked) {
-                    SpawnParticles(ppos, GRAY, 20, 10.0f);
-                } else {
-                    int dmg = bullets[i].reflected ? 35 : 18;
-                    e.health -= dmg;
-                    SpawnParticles(ppos, bullets[i].reflected ? GOLD : SKYBLUE, 15, 10.0f);
-                    player.score += bullets[i].reflected ? 80 : 30;
-                    if (e.health <= 0) {
-                        e.alive = false;
-                        player.score += 1000;
-                        player.combo += 10;
-                        SpawnParticles(e.pos, RED, 60, 16.0f);
-                        DropSouls(e.pos, e.soulValue);
-                    }
+            if (blocked) {
+                SpawnParticles(b.pos, GRAY, 20, 10.0f);
+            } else {
+                int dmg = b.reflected ? 35 : 18;
+                e.health -= dmg;
+                SpawnParticles(b.pos, b.reflected ? GOLD : SKYBLUE, 15, 10.0f);
+                player.score += b.reflected ? 80 : 30;
+                if (e.health <= 0) {
+                    e.alive = false;
+                    player.score += 1000;
+                    player.combo += 10;
+                    SpawnParticles(e.pos, RED, 60, 16.0f);
+                    DropSouls(e.pos, e.soulValue);
                 }
-                toRemove.insert(i);
             }
-        }
+            b.dead = true;
+        });
     }
 
-    for (auto rit = toRemove.rbegin(); rit != toRemove.rend(); ++rit) {
-        bullets.erase(bullets.begin() + *rit);
-    }
+    // Single stable pass; keeps firing order for drawing
+    std::erase_if(bullets, [](const Bullet& b) { return b.dead; });
 }
 
 void UpdateGame(float dt) {
     if (dt == 0.0f) return;
+    particles.BeginFrame();
 
     UpdateCamera();
     UpdatePlayer(dt);
@@ -726,34 +1411,41 @@ void UpdateGame(float dt) {
 }
 
 void Draw3D() {
+    PROFILE_ZONE("Draw3D");
     DrawPlane({0,0,0}, {200,200}, {20,25,40,255});
 
     Vector3 aimPoint = GetAimPoint();
     DrawCircle3D(aimPoint, 3.0f, {1,0,0}, 90.0f, Fade(LIME, 0.5f));
     DrawCircle3D(aimPoint, 1.5f, {1,0,0}, 90.0f, Fade(LIME, 0.8f));
 
-    for (const auto& b : bullets) {
-        DrawSphere(b.pos, BULLET_SIZE, b.color);
-        if (b.reflected) DrawSphere(b.pos, BULLET_SIZE * 1.6f, Fade(GOLD, 0.4f));
-    }
+    {
+        PROFILE_ZONE("DrawInstanced");
+        for (const auto& b : bullets) {
+            DrawInstance(sphereBatch, b.pos, BULLET_SIZE, b.color);
+            if (b.reflected) DrawInstance(sphereBatch, b.pos, BULLET_SIZE * 1.6f, Fade(GOLD, 0.4f));
+        }
 
-    for (const auto& p : particles) {
-        DrawSphere(p.pos, p.size * (p.life / p.maxLife), Fade(p.color, p.life / p.maxLife));
-    }
+        for (const auto& p : particles) {
+            DrawInstance(sphereBatch, p.pos, p.size * (p.life / p.maxLife), Fade(p.color, p.life / p.maxLife));
+        }
 
-    for (const auto& s : soulOrbs) {
-        DrawSphere(s.pos, 1.0f, Fade(GOLD, 0.7f + 0.3f * sinf(GetTime() * 8)));
+        for (const auto& s : soulOrbs) {
+            DrawInstance(sphereBatch, s.pos, 1.0f, Fade(GOLD, 0.7f + 0.3f * sinf(GetTime() * 8)));
+        }
+        FlushInstances(sphereBatch);
     }
 
     // Bonfire
     DrawCylinder(bonfirePos, 2.2f, 1.8f, 9.0f, 16, DARKBROWN);
-    for (int i = 0; i < 25; i++) {
-        float ang = i / 25.0f * PI * 2;
+    int flames = Quality().bonfireFlames;
+    for (int i = 0; i < flames; i++) {
+        float ang = (float)i / flames * PI * 2;
         float h = 3.0f + sinf(GetTime() * 10 + i) * 2.0f;
         Vector3 flame = {cosf(ang) * 2.2f, h, sinf(ang) * 2.2f};
-        DrawSphere(Vector3Add(bonfirePos, flame), 1.0f, Fade(ORANGE, 0.8f));
+        DrawQualitySphere(Vector3Add(bonfirePos, flame), 1.0f, Fade(ORANGE, 0.8f));
     }
 
+    PROFILE_ZONE("DrawActors");
     DrawPlayer();
     for (const auto& e : enemies) if (e.alive) DrawEnemy(e);
 }
@@ -767,12 +1459,12 @@ void DrawPlayer() {
     if (player.hitInvuln > 0.0f) body = Fade(body, 0.6f + 0.4f * sinf(GetTime() * 30));
 
     DrawCylinderEx({0,0,0}, {0,3,0}, 1.2f, 0.8f, 16, body);
-    DrawSphere({0,3.5f,0}, 0.9f, body);
+    DrawQualitySphere({0,3.5f,0}, 0.9f, body);
     DrawCylinderEx({-0.8f,1.5f,0}, {-1.6f,0.5f,0}, 0.4f, 0.3f, 12, DARKGRAY);
     DrawCylinderEx({0.8f,2.0f,0.6f}, {1.4f,0.8f,1.2f}, 0.35f, 0.25f, 12, GRAY);
 
     if (player.isParrying) {
-        DrawSphere({0,1.5f,0}, 5.0f, Fade(GOLD, 0.4f + 0.4f * sinf(GetTime() * 20)));
+        DrawQualitySphere({0,1.5f,0}, 5.0f, Fade(GOLD, 0.4f + 0.4f * sinf(GetTime() * 20)));
     }
 
     rlPopMatrix();
@@ -783,7 +1475,7 @@ void DrawEnemy(const Enemy& e) {
     rlTranslatef(e.pos.x, e.pos.y, e.pos.z);
     rlRotatef(e.rotation * RAD2DEG, 0,1,0);
     rlScalef(e.scale, e.scale, e.scale);
-    DrawSphere({0,2,0}, 1.8f, e.color);
+    DrawQualitySphere({0,2,0}, 1.8f, e.color);
     DrawCylinderEx({0,2,0}, {0,5,0}, 0.8f, 0.4f, 12, Fade(e.color, 0.7f));
 
     // Shield visual for SHIELDED
@@ -853,6 +1545,19 @@ void DrawHUD() {
             DrawText("BULLET LORD", SCREEN_WIDTH/2 - MeasureText("BULLET LORD", 60)/2, 20, 60, GOLD);
         }
     }
+
+    // Debug overlay (F3)
+    if (showDebugOverlay) {
+        DrawRectangle(SCREEN_WIDTH - 430, SCREEN_HEIGHT - 136, 410, 116, Fade(BLACK, 0.7f));
+        DrawText(TextFormat("INSTANCED %d IN %d DRAWS", instancesDrawn, instanceDrawCalls),
+                 SCREEN_WIDTH - 420, SCREEN_HEIGHT - 126, 20, LIME);
+        DrawText(TextFormat("PARTICLES %d / %d  (peak %d)", particles.count, MAX_PARTICLES, particles.peakCount),
+                 SCREEN_WIDTH - 420, SCREEN_HEIGHT - 100, 20, LIME);
+        DrawText(TextFormat("POOL %.1f KB  DROPPED %d", sizeof(ParticlePool) / 1024.0f, particles.dropped),
+                 SCREEN_WIDTH - 420, SCREEN_HEIGHT - 74, 20, LIME);
+        DrawText(TextFormat("BULLETS %d  FPS %d  QUALITY %s", (int)bullets.size(), GetFPS(), Quality().name),
+                 SCREEN_WIDTH - 420, SCREEN_HEIGHT - 48, 20, LIME);
+    }
 }
 
 void DrawBonfireMenu() {
@@ -885,7 +1590,7 @@ void DrawTitle() {
 void DrawDeath() {
     DrawRectangle(0,0,SCREEN_WIDTH,SCREEN_HEIGHT,Fade(BLACK,0.9f));
     DrawText("YOU DIED", SCREEN_WIDTH/2 - MeasureText("YOU DIED", 140)/2, SCREEN_HEIGHT/2 - 100, 140, RED);
-    const char* quote = deathQuotes[GetRandomValue(0, deathQuotes.size()-1)].c_str();
+    const char* quote = deathQuotes[fxRng.Range(0, deathQuotes.size()-1)].c_str();
     DrawText(quote, SCREEN_WIDTH/2 - MeasureText(quote, 60)/2, SCREEN_HEIGHT/2 + 40, 60, ORANGE);
     DrawText("All souls and upgrades lost...", SCREEN_WIDTH/2 - MeasureText("All souls and upgrades lost...", 50)/2, SCREEN_HEIGHT/2 + 120, 50, DARKGRAY);
     if (totalEnemyBullets > 0) {
@@ -901,4 +1606,81 @@ void DrawVictory() {
     DrawText(TextFormat("FINAL ACCURACY: %.1f%%", accuracy), SCREEN_WIDTH/2 - MeasureText("FINAL ACCURACY: 100.0%", 60)/2, 360, 60, accuracy >= 99.0f ? LIME : WHITE);
     if (accuracy >= 99.0f) DrawText("TRUE GIT GUD ACHIEVED", SCREEN_WIDTH/2 - MeasureText("TRUE GIT GUD ACHIEVED", 60)/2, 460, 60, GOLD);
     DrawText("You have conquered the ultimate trial.", SCREEN_WIDTH/2 - MeasureText("You have conquered the ultimate trial.", 40)/2, SCREEN_HEIGHT - 120, 40, LIGHTGRAY);
-}
\ No newline at end of file
+}
+
+// ======================================================================
+// Headless Benchmark
+// ======================================================================
+#ifdef HEADLESS
+// Deterministic input script: circle-strafe while shooting at the nearest
+// enemy, parry on a fixed rhythm, heal when low, and advance through the
+// title, bonfire and death screens.
+void HeadlessScriptInput(int frame) {
+    std::memset(headless.keyDown, 0, sizeof(headless.keyDown));
+    std::memset(headless.keyPressed, 0, sizeof(headless.keyPressed));
+    std::memset(headless.mouseDown, 0, sizeof(headless.mouseDown));
+
+    const int walkKeys[4] = {KEY_W, KEY_D, KEY_S, KEY_A};
+    headless.keyDown[walkKeys[(frame / 60) % 4]] = true;
+    headless.mouseDown[MOUSE_LEFT_BUTTON] = true;
+    if (frame % 30 == 0) headless.keyPressed[KEY_SPACE] = true;
+    if (player.health < player.maxHealth / 3) headless.keyPressed[KEY_E] = true;
+    if (state == TITLE) headless.keyPressed[KEY_ENTER] = true;
+    if (state == DEAD) headless.keyPressed[KEY_R] = true;
+
+    float bestDist = 1e9f;
+    for (const auto& e : enemies) {
+        if (!e.alive) continue;
+        float d = Vector3Distance(e.pos, player.pos);
+        if (d < bestDist) {
+            bestDist = d;
+            headless.aimPoint = e.pos;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int frames = 3600;
+    uint64_t seed = 1;
+    const char* tracePath = nullptr;  // Chrome trace output, PROFILE=1 builds only
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--frames") == 0) frames = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--seed") == 0) seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--entities") == 0) waveOneGruntCount = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--trace") == 0) tracePath = argv[i + 1];
+    }
+
+    SeedRandom(seed);
+    InitGame();
+
+    double maxFrameMs = 0.0;
+    for (headless.frame = 0; headless.frame < frames; headless.frame++) {
+        PROFILE_FRAME();
+        HeadlessScriptInput(headless.frame);
+        auto start = std::chrono::steady_clock::now();
+        UpdateFrame(headless.frameTime);
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        headless.systemMs[HS_UPDATE] += ms.count();
+        maxFrameMs = std::max(maxFrameMs, ms.count());
+        if (state == VICTORY) break;
+    }
+
+    int alive = 0;
+    for (const auto& e : enemies) if (e.alive) alive++;
+    int ran = std::max(headless.frame, 1);
+    printf("{\"game\":\"parry\",\"frames\":%d,\"seed\":%llu,\"entities\":%d,"
+           "\"maxFrameMs\":%.4f,\"systems\":{", ran, (unsigned long long)seed, waveOneGruntCount, maxFrameMs);
+    for (int i = 0; i < HS_COUNT; i++) {
+        printf("%s\"%s\":{\"totalMs\":%.4f,\"avgUs\":%.3f}", i ? "," : "", HEADLESS_SYSTEM_NAMES[i],
+               headless.systemMs[i], headless.systemMs[i] * 1000.0 / ran);
+    }
+    printf("},\"state\":{\"wave\":%d,\"alive\":%d,\"bullets\":%d,\"score\":%d}}\n",
+           wave, alive, (int)bullets.size(), player.score);
+#ifdef ENABLE_PROFILER
+    if (tracePath && !ProfileWriteTrace(tracePath)) fprintf(stderr, "could not write %s\n", tracePath);
+#else
+    (void)tracePath;
+#endif
+    return 0;
+}
+#endif